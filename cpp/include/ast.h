@@ -1,11 +1,14 @@
 // ast.h
-// Declares: AstType, Operator, Expr, Statement
+// Declares: AstType, Operator, SlotRef, CallTarget, ExprId, StmtId, Expr, Block,
+// Statement, NodeArena, Ast
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -44,6 +47,8 @@ inline AstType astCreateNull() {
     return a;
 }
 
+/// Script caches store operators as numbers: bump `FORMAT_VERSION` in script_cache.cpp when
+/// adding, removing or reordering one
 enum class Operator {
     /// Addition (+)
     Add,
@@ -79,50 +84,80 @@ enum class Operator {
     Concat,
 };
 
-struct Expr;
-using ExprPtr = std::unique_ptr<Expr>;
-struct RuntimeValue;
-struct Expr {
-    Expr() = default;
-    Expr(const Expr& other);
-    Expr& operator=(const Expr& other);
+/// @brief Storage of a variable: `slot` in the frame `depth` levels up. Depth 0 is the current
+/// function (or script) frame, depth 1 the global frame seen from inside a function. Filled in by
+/// `resolver::Resolver`, which settles shadowing statically, so a reference has exactly one slot
+struct SlotRef {
+    /// `slot` of a name that is never assigned where it is read; reading it is an error
+    static constexpr std::uint32_t UNBOUND = UINT32_MAX;
+
+    std::uint32_t depth = 0;
+    std::uint32_t slot = UNBOUND;
+};
+
+/// @brief What a call refers to. The parser resolves builtins and methods and `resolver::Resolver`
+/// numbers user functions, so the engines dispatch on `id` instead of looking names up
+struct CallTarget {
+    enum class Kind : std::uint8_t {
+        /// user function, `id` is its number
+        Function,
+        /// `id` is a `builtin_functions::BuiltinId`
+        Builtin,
+        /// `id` is a `MethodDispatcher::MethodId`; the receiver is the first argument
+        Method,
+        /// exit()
+        Exit,
+    };
 
-    Expr(Expr&&) noexcept = default;
-    Expr& operator=(Expr&&) noexcept = default;
+    Kind kind = Kind::Function;
+    std::uint32_t id = 0;
+};
+
+/// @brief Id of an expression in `Ast::exprs`
+using ExprId = std::uint32_t;
+/// @brief Id of a statement in `Ast::stmts`
+using StmtId = std::uint32_t;
 
+struct RuntimeValue;
+struct Expr {
     struct Literal {
         RuntimeValue value;
     };
     struct Variable {
         std::string name;
+        SlotRef binding;
     };
     struct UnaryOp {
         Operator op;
-        ExprPtr next;
+        ExprId next;
     };
     struct BinaryOp {
-        ExprPtr left;
+        ExprId left;
         Operator op;
-        ExprPtr right;
+        ExprId right;
     };
     struct FunctionCall {
         std::string name;
-        std::vector<ExprPtr> args;
+        std::vector<ExprId> args;
+        CallTarget target;
+        /// set by `typechecker::TypeChecker` when the arguments are known to match the called
+        /// function's parameter types; they aren't checked again at runtime then
+        bool args_proven;
     };
     struct Ternary {
-        ExprPtr condition;
-        ExprPtr then_expr;
-        ExprPtr else_expr;
+        ExprId condition;
+        ExprId then_expr;
+        ExprId else_expr;
     };
     struct ListLiteral {
-        std::vector<ExprPtr> elements;
+        std::vector<ExprId> elements;
     };
     struct TypeCast {
         AstType target_type;
-        ExprPtr expr;
+        ExprId expr;
     };
     struct MemberAccess {
-        ExprPtr object;
+        ExprId object;
         std::string member;
     };
 
@@ -133,59 +168,140 @@ struct Expr {
     Variant value;
 };
 
-struct Statement;
-using StmtPtr = std::unique_ptr<Statement>;
-struct Statement {
-    Statement() = default;
-    Statement(const Statement& other);
-    Statement& operator=(const Statement& other);
+/// @brief Statement list executed in its own scope. A block's variables live in a slot range of
+/// the enclosing frame, which is cleared whenever the block is entered
+struct Block {
+    Block() = default;
+    Block(std::vector<StmtId> stmts) : statements(std::move(stmts)) {}
 
-    Statement(Statement&&) noexcept = default;
-    Statement& operator=(Statement&&) noexcept = default;
+    std::vector<StmtId> statements;
+    /// first frame slot of the scope's own variables, set by `resolver::Resolver`
+    std::uint32_t first_slot = 0;
+    /// number of slots the scope's own variables take, set by `resolver::Resolver`
+    std::uint32_t num_slots = 0;
+};
 
+struct Statement {
     struct Assignment {
         std::string name;
-        Expr expr;
+        ExprId expr;
+        SlotRef target;
     };
 
     struct VarDecl {
         std::string name;
         AstType type;
-        std::optional<Expr> initializer;
+        std::optional<ExprId> initializer;
+        SlotRef target;
+        /// set by `typechecker::TypeChecker` when the initializer is known to match `type`; it
+        /// isn't checked again at runtime then
+        bool initializer_proven;
     };
 
     struct If {
-        Expr condition;
-        std::vector<StmtPtr> body;
-        std::vector<std::pair<Expr, std::vector<StmtPtr>>> elif;
-        std::vector<StmtPtr> else_body;
+        ExprId condition;
+        Block body;
+        std::vector<std::pair<ExprId, Block>> elif;
+        Block else_body;
     };
 
     struct While {
-        Expr condition;
-        std::vector<StmtPtr> body;
+        ExprId condition;
+        Block body;
     };
 
     struct Return {
-        Expr value;
+        ExprId value;
     };
 
     struct FunctionDef {
         std::string name;
         std::vector<std::pair<std::string, AstType>> params;
-        std::vector<StmtPtr> body;
+        /// function scope; `num_slots` includes the parameters
+        Block body;
         std::optional<AstType> return_type;
+        /// frame slot each parameter is bound to on call, parallel to `params`
+        std::vector<std::uint32_t> param_slots;
+        /// slots of the whole frame, including those of nested blocks
+        std::uint32_t frame_slots;
+        /// number shared with the calls to this function (see `CallTarget`)
+        std::uint32_t function_id;
+        /// set by `typechecker::TypeChecker` when every returned value is known to match
+        /// `return_type`; they aren't checked again at runtime then
+        bool returns_proven;
     };
 
     struct Break {};
     struct Continue {};
 
     struct ExpressionStmt {
-        Expr expr;
+        ExprId expr;
     };
 
     using Variant = std::variant<Assignment, VarDecl, If, While, Return, FunctionDef, Break,
                                  Continue, ExpressionStmt>;
 
     Variant value;
-};
\ No newline at end of file
+};
+
+/// @brief Append-only node storage. Nodes are numbered densely like vector elements but stored
+/// in fixed-size chunks, so growing the arena never moves a node: no reallocation copies, no
+/// doubling slack, and references stay valid while nodes are added
+template <typename T>
+class NodeArena {
+   public:
+    static constexpr std::uint32_t CHUNK_BITS = 10;
+    static constexpr std::uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+
+    /// @return Index of the appended node
+    std::uint32_t push(T node) {
+        if (size_ % CHUNK_SIZE == 0) {
+            chunks_.emplace_back();
+            chunks_.back().reserve(CHUNK_SIZE);
+        }
+        chunks_.back().push_back(std::move(node));
+        return size_++;
+    }
+
+    T& operator[](std::uint32_t id) {
+        return chunks_[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+    }
+    const T& operator[](std::uint32_t id) const {
+        return chunks_[id >> CHUNK_BITS][id & (CHUNK_SIZE - 1)];
+    }
+
+    std::uint32_t size() const noexcept {
+        return size_;
+    }
+
+   private:
+    std::vector<std::vector<T>> chunks_;
+    std::uint32_t size_ = 0;
+};
+
+/// @brief A parsed script. Nodes live in two arenas and refer to their children by 32-bit id, so
+/// they aren't allocated one by one and a walk stays within a few contiguous chunks
+struct Ast {
+    NodeArena<Expr> exprs;
+    NodeArena<Statement> stmts;
+    /// top-level statements, in source order
+    std::vector<StmtId> root;
+
+    /// @brief Appends a node to the arena
+    /// @return Id of the new node
+    ExprId add(Expr expr);
+    StmtId add(Statement stmt);
+
+    Expr& expr(ExprId id) {
+        return exprs[id];
+    }
+    const Expr& expr(ExprId id) const {
+        return exprs[id];
+    }
+    Statement& stmt(StmtId id) {
+        return stmts[id];
+    }
+    const Statement& stmt(StmtId id) const {
+        return stmts[id];
+    }
+};
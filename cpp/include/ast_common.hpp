@@ -3,12 +3,12 @@
 
 #pragma once
 
-#include <cstddef>
+#include <cstdint>
 
 /// @brief Position in source code. Has operators `==` and `!=` to compare two Pos
 struct Pos {
-    std::size_t line;
-    std::size_t column;
+    std::uint32_t line;
+    std::uint32_t column;
 
     bool operator==(const Pos& other) const {
         return (line == other.line) && (column == other.column);
@@ -12,6 +12,9 @@ namespace builtins {
 
 class Alert {
    public:
+    /// @brief When false (`--no-alerts`), no dialog is shown and every alert is dismissed
+    bool enabled = true;
+
     Result<RuntimeValue> show_ok(const std::string& title, const std::string& message);
     Result<RuntimeValue> show_ok_cancel(const std::string& title, const std::string& message);
     Result<RuntimeValue> show_yes_no_cancel(const std::string& title, const std::string& message);
@@ -13,6 +13,9 @@ namespace builtins {
 /// @brief Provides console output functionality
 class Console {
    public:
+    /// @brief When false (`--no-console`), `print` writes nothing
+    bool enabled = true;
+
     /// @brief Prints a message to standard output
     /// @param message The message to print (already converted to string)
     /// @return Result containing null (always succeeds, even if no console is available)
@@ -20,6 +20,9 @@ class Logger {
     std::unique_ptr<std::ofstream> log_stream;
 
    public:
+    /// @brief When false (`--no-logs`), `log` discards its message, even without a log file
+    bool enabled = true;
+
     Logger() = default;
     ~Logger();
 
@@ -0,0 +1,162 @@
+// bytecode.h
+// Declares: OpCode, Instruction, Variable, CallSite, FunctionProto, Program
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ast.h"
+#include "errors.hpp"
+#include "runtime_value.h"
+
+/// @brief Register-based bytecode produced by the compiler and executed by the VM
+namespace bytecode {
+
+/// @brief Operand value used when an optional operand (e.g. a type index) is absent
+inline constexpr std::uint32_t NO_OPERAND = std::numeric_limits<std::uint32_t>::max();
+
+/// @brief VM instructions. Operand meaning is listed per opcode; registers are relative to the
+/// current frame
+enum class OpCode : std::uint8_t {
+    /// a = dst, b = constant index
+    LoadConst,
+    /// a = dst, b = src
+    Move,
+    /// a = dst, b = variable index
+    LoadVar,
+    /// a = variable index, b = src. Same semantics as `Environment::set`
+    StoreVar,
+    /// a = dst, b = variable index. Like LoadVar, but moves the value out of its slot and leaves
+    /// null there; the slot must be written back before anything reads it. `dst` must be the
+    /// highest register in use: the free ones above it are cleared, so `dst` is left as the
+    /// value's only holder
+    TakeVar,
+    /// a = register, b = type index, c = error index raised when the value doesn't match
+    TypeCheck,
+    /// a = first slot, b = slot count. Clears a block scope's slots in the current frame
+    EnterBlock,
+    /// a = dst, b = src
+    Not,
+    /// a = dst, b = src
+    Neg,
+    /// a = dst, b = src. Stores `is_truthy(src)` as a bool
+    ToBool,
+    /// a = dst, b = lhs, c = rhs
+    Add,
+    Sub,
+    Mul,
+    Div,
+    Pow,
+    Eq,
+    Ne,
+    Gt,
+    Lt,
+    Ge,
+    Le,
+    Concat,
+    /// a = dst, b = lhs, c = rhs. Int×int forms of the operators above, chosen by the compiler
+    /// when both operands are declared `int`. Operands that turn out to be anything else (a
+    /// variable can be reassigned to another type) take the generic path
+    AddInt,
+    SubInt,
+    MulInt,
+    EqInt,
+    NeInt,
+    GtInt,
+    LtInt,
+    GeInt,
+    LeInt,
+    /// a = dst, b = lhs, c = rhs. Float×float forms, same guard as the int ones. A zero divisor
+    /// also takes the generic path, which raises the error
+    AddFloat,
+    SubFloat,
+    MulFloat,
+    DivFloat,
+    EqFloat,
+    NeFloat,
+    GtFloat,
+    LtFloat,
+    GeFloat,
+    LeFloat,
+    /// a = target pc
+    Jump,
+    /// a = condition register, b = target pc
+    JumpIfFalse,
+    /// a = condition register, b = target pc
+    JumpIfTrue,
+    /// a = dst, b = call site index, c = first argument register
+    Call,
+    /// a = dst, b = first element register, c = element count
+    NewList,
+    /// a = dst, b = src, c = type index
+    Cast,
+    /// a = dst, b = src, c = name index
+    GetMember,
+    /// a = list register, b = value register. Appends in place, see `ListMethods::pushInPlace`
+    ListPush,
+    /// a = string register, b = value register. Appends in place, see
+    /// `runtime_utils::concat_in_place`
+    StringAppend,
+    /// a = function index, b = function id (see `CallTarget`). Makes the function callable
+    DefineFunction,
+    /// a = src
+    Return,
+    ReturnNull,
+    /// a = error index
+    Raise,
+};
+
+struct Instruction {
+    OpCode op;
+    std::uint32_t a = 0;
+    std::uint32_t b = 0;
+    std::uint32_t c = 0;
+};
+
+/// @brief A resolved variable reference. The name is only kept for error messages
+struct Variable {
+    std::string name;
+    SlotRef binding;
+};
+
+struct CallSite {
+    /// only kept for error messages
+    std::string name;
+    std::uint32_t argc;
+    CallTarget target;
+    /// whether the arguments are proven to match the parameter types, see
+    /// `Expr::FunctionCall::args_proven`
+    bool args_proven = false;
+};
+
+struct FunctionProto {
+    std::string name;
+    /// parameters as (frame slot, type index)
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> params;
+    /// type index of the declared return type, or NO_OPERAND if none was declared
+    std::uint32_t return_type = NO_OPERAND;
+    /// whether returned values are proven to match `return_type`, see
+    /// `Statement::FunctionDef::returns_proven`
+    bool returns_proven = false;
+    std::uint32_t num_registers = 0;
+    /// slot count of the function's frame
+    std::uint32_t num_slots = 0;
+    std::vector<Instruction> code;
+};
+
+/// @brief A compiled script. `functions[0]` is the top-level script body
+struct Program {
+    std::vector<FunctionProto> functions;
+    std::vector<RuntimeValue> constants;
+    std::vector<std::string> names;
+    std::vector<Variable> variables;
+    std::vector<AstType> types;
+    std::vector<CallSite> call_sites;
+    std::vector<Error> errors;
+};
+
+}  // namespace bytecode
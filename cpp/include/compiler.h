@@ -0,0 +1,86 @@
+// compiler.h
+// Declares: Compiler
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+#include "bytecode.h"
+
+namespace compiler {
+
+/// @brief Lowers parsed `Statement`/`Expr` trees into a register-based `bytecode::Program`.
+/// Semantics mirror the tree-walking `Interpreter::eval_statements`/`eval_expr` exactly, so both
+/// engines can be run against each other
+class Compiler {
+   public:
+    /// @brief Compiles a whole script. Function definitions are compiled into separate protos
+    /// @param ast The script as returned by `parser::Parser::parse()`, annotated by
+    /// `resolver::Resolver`
+    /// @return Program whose `functions[0]` is the script body
+    bytecode::Program compile(const Ast& ast);
+
+   private:
+    struct Loop {
+        std::size_t start;
+        std::vector<std::size_t> break_jumps;
+    };
+
+    /// @brief Static type of an expression, as far as declarations determine it
+    enum class Kind { Int, Float, Other };
+
+    struct FunctionState {
+        std::uint32_t index;
+        bool is_script;
+        std::uint32_t next_register = 0;
+        std::vector<Loop> loops;
+    };
+
+    void compile_function(const Statement::FunctionDef& fd);
+    void compile_block(const Block& block);
+    void compile_statement(StmtId id);
+    /// @brief Compiles an expression into `dst`
+    /// @return What the expression evaluates to, inferred from literals and declared variable
+    /// types. Only a hint for picking typed instructions, which check their operands at run time
+    Kind compile_expr(ExprId id, std::uint32_t dst);
+    void compile_break_or_continue(bool is_break);
+    static Kind kind_of(const AstType& type);
+    /// @brief Declared type of the variable in a resolved slot, as far as compiled so far
+    Kind& declared(SlotRef ref);
+    /// @brief Compiles `x = x.push(v)` as an in-place append if that is unobservable
+    /// @return false if the assignment doesn't have that shape; nothing was emitted then
+    bool compile_push_assignment(const Statement::Assignment& a);
+    /// @brief Compiles `x = x ++ a ++ b ...` as in-place appends if that is unobservable
+    /// @return false if the assignment doesn't have that shape; nothing was emitted then
+    bool compile_concat_assignment(const Statement::Assignment& a);
+
+    std::uint32_t alloc_register();
+    void free_register(std::uint32_t reg);
+    std::size_t emit(bytecode::OpCode op, std::uint32_t a = 0, std::uint32_t b = 0,
+                     std::uint32_t c = 0);
+    std::size_t here() const;
+    void patch_jump(std::size_t at, std::size_t target);
+    std::vector<bytecode::Instruction>& code();
+
+    std::uint32_t add_constant(RuntimeValue value);
+    std::uint32_t add_name(const std::string& name);
+    std::uint32_t add_variable(const std::string& name, SlotRef binding);
+    std::uint32_t add_type(const AstType& type);
+    std::uint32_t add_error(const std::string& message, ErrorKind kind);
+
+    const Ast* ast_ = nullptr;
+    bytecode::Program program_;
+    FunctionState* current_ = nullptr;
+    std::unordered_map<std::string, std::uint32_t> name_ids_;
+    /// declared type of each variable in scope, by slot of the script frame and of the function
+    /// being compiled
+    std::vector<Kind> global_kinds_;
+    std::vector<Kind> local_kinds_;
+};
+
+}  // namespace compiler
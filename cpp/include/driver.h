@@ -0,0 +1,76 @@
+// driver.h
+// Declares: Options, parse_args, print_usage, Origin, Script, load_script, run_script
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ast.h"
+#include "result.hpp"
+#include "runtime.h"
+
+/// @brief The steps of one `copycleaner` run (load, parse, resolve, execute, report), shared by
+/// `main` and the daemon (see server.h)
+namespace driver {
+
+/// @brief Command line of one run
+struct Options {
+    std::string filename;
+    Engine engine = Engine::Bytecode;
+    bool print_stats = false;
+    bool bench_lexer = false;
+    bool use_cache = true;
+    /// cleared by `--no-alerts`, `--no-logs` and `--no-console`
+    bool alerts = true;
+    bool logs = true;
+    bool console = true;
+    /// serve runs over `socket_path` instead of running a script
+    bool daemon = false;
+    /// forward the run to the daemon on `socket_path`; runs locally if none is listening
+    bool client = false;
+    /// empty for `server::default_socket_path()`
+    std::string socket_path;
+};
+
+/// @brief Parses the arguments after the program name
+/// @return The options, or an error naming the first argument that isn't one
+Result<Options> parse_args(const std::vector<std::string>& args);
+
+/// @brief Prints the usage text to stderr
+void print_usage(const char* program);
+
+/// @brief Where a `Script`'s AST came from, as reported by `--stats`
+enum class Origin {
+    /// lexed and parsed
+    Parsed,
+    /// loaded from the on-disk cache (see script_cache.h)
+    DiskCache,
+    /// kept in memory by the daemon from an earlier run
+    Resident,
+};
+
+/// @brief A parsed and resolved script, ready to run any number of times
+struct Script {
+    Ast ast;
+    std::uint32_t global_slots;
+    Origin origin;
+};
+
+/// @brief Parses, resolves and type checks `source`, going through the on-disk cache if
+/// `use_cache`. Parse and type errors are reported on stderr
+/// @param filename Path of the script, which locates its cache
+/// @param source Contents of the script
+/// @return The script, or nothing if it doesn't parse or type check
+std::optional<Script> load_script(const std::string& filename, std::string_view source,
+                                  bool use_cache);
+
+/// @brief Runs `script` on a fresh `Interpreter`, then reports runtime errors and the `--stats`
+/// counters on stderr
+/// @return Exit code: 0, or 3 on a runtime error
+int run_script(const Script& script, const Options& options);
+
+}  // namespace driver
@@ -1,13 +1,16 @@
 // errors.hpp
-// Declares/Implements: ErrorKind, Error
+// Declares/Implements: ErrorKind, ErrorMessage, Error
 
 #pragma once
 
+#include <cstddef>
 #include <format>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <variant>
 
 #include "ast_common.hpp"
 
@@ -24,8 +27,29 @@ inline const char* to_string(ErrorKind kind) {
                                              "DivideByZero", "Exit", "Parse"};
     return names[static_cast<size_t>(kind)];
 }
+/// @brief The message of an `Error`: a string literal, which is referenced, or a string assembled
+/// at runtime, which is moved in. Only arrays whose address is a constant (string literals and
+/// other static arrays) are accepted without a copy; a local buffer fails to compile instead of
+/// dangling, and has to be passed as a `std::string`
+class ErrorMessage {
+   public:
+    template <std::size_t N>
+    consteval ErrorMessage(const char (&literal)[N]) : text_(literal) {}
+    ErrorMessage(std::string text) : text_(std::move(text)) {}
+
+   private:
+    friend class Error;
+    std::variant<const char*, std::string> text_;
+};
+
+/// @brief An error raised while parsing or running a script. Only created on the failure path
+/// and passed around behind a `Shared` handle (see `ErrorPtr` in result.hpp).
+///
+/// A message given as a string literal is referenced rather than copied (see `ErrorMessage`), so
+/// most errors cost a single allocation; the `fmt()` text is only put together when it is printed
 class Error {
-    std::string message_;
+    /// string literal, or a message assembled by the caller
+    std::variant<const char*, std::string> message_;
     std::optional<Span> span_;
     ErrorKind kind_;
 
@@ -40,8 +64,8 @@ class Error {
      * @param message The error message
      * @param kind The error category (default: Runtime)
      */
-    Error(std::string message, ErrorKind kind = ErrorKind::Runtime)
-        : message_(std::move(message)), kind_(kind) {}
+    Error(ErrorMessage message, ErrorKind kind = ErrorKind::Runtime)
+        : message_(std::move(message.text_)), kind_(kind) {}
 
     /**
      * @brief Create an error with source location
@@ -49,11 +73,12 @@ class Error {
      * @param span The source location where the error occurred
      * @param kind The error category (default: Runtime)
      */
-    Error(std::string message, const Span& span, ErrorKind kind = ErrorKind::Runtime)
-        : message_(std::move(message)), span_(span), kind_(kind) {}
+    Error(ErrorMessage message, const Span& span, ErrorKind kind = ErrorKind::Runtime)
+        : message_(std::move(message.text_)), span_(span), kind_(kind) {}
 
-    const std::string& what() const noexcept {
-        return message_;
+    std::string_view what() const noexcept {
+        if (auto literal = std::get_if<const char*>(&message_)) return *literal;
+        return std::get<std::string>(message_);
     }
     ErrorKind kind() const noexcept {
         return kind_;
@@ -71,8 +96,8 @@ class Error {
     std::string fmt() const {
         auto span_str = fmt_span();
         if (span_str.empty()) {
-            return std::format("{} Error: {}", to_string(kind_), message_);
+            return std::format("{} Error: {}", to_string(kind_), what());
         }
-        return std::format("{} Error {}: {}", to_string(kind_), span_str, message_);
+        return std::format("{} Error {}: {}", to_string(kind_), span_str, what());
     }
-};
\ No newline at end of file
+};
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <deque>
 #include <string>
 #include <string_view>
 
@@ -62,10 +63,14 @@ enum class TokenKind {
 
 struct Token {
     TokenKind kind;
-    std::string lexeme;
+    /// view into the source, or into the lexer for string literals whose escapes were decoded;
+    /// valid as long as both are
+    std::string_view lexeme;
     Span span;
 };
 
+/// @brief Splits source into tokens without copying it. `source` must outlive the lexer and
+/// every token it returns
 class Lexer {
    public:
     Lexer(std::string_view source);
@@ -84,13 +89,18 @@ class Lexer {
     Token read_regex(Pos start);
     Token read_backslash_regex(Pos start);
     bool handle_escape_sequence(std::string& lex);
+    /// @brief Keeps a decoded string literal alive for the lexer's lifetime
+    /// @return View of the stored copy
+    std::string_view store(std::string lex);
 
     std::string_view src_;
     size_t pos_ = 0;
-    size_t line_ = 1;
-    size_t column_ = 1;
+    std::uint32_t line_ = 1;
+    std::uint32_t column_ = 1;
 
     TokenKind last_token_kind_ = TokenKind::Unknown;
+    /// string literals that contained escapes; a deque so stored strings never move
+    std::deque<std::string> decoded_;
 };
 
 }  // namespace lexer
\ No newline at end of file
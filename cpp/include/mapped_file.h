@@ -0,0 +1,46 @@
+// mapped_file.h
+// Declares: MappedFile
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+/// @brief A file mapped read-only into memory, so its contents can be lexed in place without
+/// being copied into a string. Files that can't be mapped (pipes, devices) are read into memory
+/// instead. The contents live as long as the object; views returned by `view()` must not outlive
+/// it
+class MappedFile {
+   public:
+    /// @brief Maps or reads the whole file at `path`; check `is_open()` afterwards
+    /// @param allow_mapping false to always read the file. Touching a mapping of a file that was
+    /// truncated in the meantime raises SIGBUS, which only a one-shot process can shrug off
+    explicit MappedFile(const std::string& path, bool allow_mapping = true);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// @return false if the file couldn't be opened
+    bool is_open() const noexcept {
+        return open_;
+    }
+
+    /// @return The file's contents; empty for an empty file
+    std::string_view view() const noexcept {
+        return {data_, size_};
+    }
+
+   private:
+    /// @return Whether the file could be mapped
+    bool map(const std::string& path);
+
+    /// contents of a file that couldn't be mapped
+    std::string buffered_;
+    const char* data_ = nullptr;
+    std::size_t size_ = 0;
+    bool open_ = false;
+    /// whether `data_` is a mapping to release
+    bool mapped_ = false;
+};
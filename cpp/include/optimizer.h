@@ -0,0 +1,38 @@
+// optimizer.h
+// Declares: Optimizer
+
+#pragma once
+
+#include <vector>
+
+#include "ast.h"
+
+namespace optimizer {
+
+/// @brief Simplifies a parsed script before it is resolved, so neither engine recomputes what the
+/// source already determines:
+/// - operators, casts and member accesses whose operands are all literals are replaced by their
+///   result, computed with the same `runtime_utils` functions the engines use. An operation that
+///   fails is left alone, so the error is still raised if and when it runs;
+/// - `false && x` and `true || x` become literals without looking at `x`, as at runtime;
+/// - a ternary with a literal condition becomes the chosen branch;
+/// - `if`/`elif` branches with literal conditions are dropped or made unconditional,
+///   `while (false)` loops and literal expression statements are removed.
+///
+/// Only values a literal can hold (ints, floats, bools, strings, regexes, null) are folded
+class Optimizer {
+   public:
+    /// @brief Simplifies `ast` in place. Nodes that become unreachable stay in the arenas
+    void optimize(Ast& ast);
+
+   private:
+    void fold_expr(ExprId id);
+    void simplify_statement(StmtId id);
+    void remove_dead(std::vector<StmtId>& statements);
+
+    Ast* ast_ = nullptr;
+    /// statements found to do nothing, indexed by id
+    std::vector<bool> dead_;
+};
+
+}  // namespace optimizer
@@ -3,8 +3,11 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "ast.h"
@@ -17,7 +20,9 @@ class Parser {
    public:
     explicit Parser(lexer::Lexer& lexer);
 
-    Result<std::vector<Statement>> parse();
+    /// @brief Parses the whole token stream
+    /// @return The script's nodes, or the first syntax error
+    Result<Ast> parse();
 
    private:
     // Statement parsing
@@ -47,16 +52,36 @@ class Parser {
     Result<AstType> parse_type();
 
     // Helpers
-    lexer::Token peek();
-    lexer::Token peek_ahead(int offset);
+    const lexer::Token& peek();
+    /// @brief Token `offset` places after the current one, lexed at most once however often it
+    /// is peeked. Stops at the last token before a lexer error
+    /// @param offset At most `LOOKAHEAD`
+    const lexer::Token& peek_ahead(std::size_t offset);
     lexer::Token advance();
     bool check(lexer::TokenKind kind);
     bool match(lexer::TokenKind kind);
-    Result<lexer::Token> expect(lexer::TokenKind kind, const std::string& msg);
+    Result<lexer::Token> expect(lexer::TokenKind kind, std::string_view msg);
+
+    /// @brief A lexed token that hasn't been consumed yet
+    struct Lookahead {
+        lexer::Token token;
+        /// false if the lexer failed here; `token` is unset then
+        bool ok;
+    };
+    /// @brief Makes sure the buffer holds at least `count` tokens after the current one
+    void fill_lookahead(std::size_t count);
+
+    static constexpr std::size_t LOOKAHEAD = 4;
 
     lexer::Lexer& lexer_;
     lexer::Token current_;
+    /// ring buffer of the next tokens, starting at `lookahead_head_`
+    std::array<Lookahead, LOOKAHEAD> lookahead_{};
+    std::size_t lookahead_head_ = 0;
+    std::size_t lookahead_count_ = 0;
     bool had_error_ = false;
+    /// nodes parsed so far; handed to the caller by `parse`
+    Ast ast_;
 };
 
 }  // namespace parser
@@ -0,0 +1,99 @@
+// regex_engine.h
+// Declares: Group, Captures, SearchMode, Scratch, Program, compile, for_each_match
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "result.hpp"
+
+/// @brief Regex backends behind one interface. Patterns in the supported subset run on a Pike VM
+/// (a Thompson NFA simulation that also tracks capture groups), which is linear in the input and
+/// doesn't recurse, so multi-MB clipboard buffers can neither stall nor overflow the stack.
+/// Anything outside the subset (backreferences, lookaround, ...) is handed to `std::regex`.
+///
+/// Supported subset: literal bytes, `.`, `^`, `$`, `\b`, `\B`, classes `[...]` / `[^...]` with
+/// ranges, `\d \w \s` and their negations, the escapes `\n \r \t \f \v \0 \xHH \uHHHH` (ASCII
+/// only), capturing and `(?:...)` groups, `|` and greedy or lazy `* + ? {n} {n,} {n,m}`. The `i`
+/// flag folds ASCII case; other flags are ignored, as they always were
+namespace regex_engine {
+
+/// @brief Byte offsets of a capture group in the searched text
+struct Group {
+    static constexpr std::size_t NPOS = static_cast<std::size_t>(-1);
+
+    /// NPOS if the group didn't take part in the match
+    std::size_t start = NPOS;
+    std::size_t end = NPOS;
+
+    bool matched() const noexcept {
+        return start != NPOS;
+    }
+};
+
+/// @brief Group 0 is the whole match, followed by one entry per capturing group
+using Captures = std::vector<Group>;
+
+struct SearchMode {
+    /// only accept a match that starts exactly at `from`
+    bool anchored = false;
+    /// reject empty matches
+    bool not_empty = false;
+};
+
+/// @brief Working memory of `Program::search`. Successive searches given the same scratch (like
+/// those of `for_each_match`) reuse its buffers instead of allocating their own. It holds nothing
+/// from one search to the next and works with any program, but only one search at a time
+class Scratch {
+   public:
+    Scratch();
+    ~Scratch();
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+
+    /// engine-specific buffers, created by the first search that needs them
+    struct Buffers;
+    std::unique_ptr<Buffers> buffers;
+};
+
+/// @brief A compiled pattern. Immutable, so one program can be shared by all regex values with
+/// the same literal and flags
+class Program {
+   public:
+    virtual ~Program() = default;
+
+    /// @brief Finds the leftmost match starting at or after `from`, picking among matches at the
+    /// same start the way ECMAScript backtracking would (so both backends agree). Assertions like
+    /// `^` and `\b` see all of `text`, not just the part after `from`
+    /// @param caps Set to the groups of the match if one is found
+    /// @param scratch Buffers to work in
+    /// @return Whether a match was found
+    /// @throws std::regex_error from the `std::regex` backend when it hits its complexity or stack
+    /// limits
+    virtual bool search(std::string_view text, std::size_t from, SearchMode mode, Captures& caps,
+                        Scratch& scratch) const = 0;
+
+    /// @brief Number of capturing groups, not counting group 0
+    virtual std::size_t group_count() const noexcept = 0;
+
+    /// @brief Whether the program runs on the linear-time engine
+    virtual bool is_linear() const noexcept = 0;
+};
+
+/// @brief Compiles `/literal/flags`, preferring the linear-time engine
+/// @return The program, or a runtime error if the pattern is invalid
+Result<std::shared_ptr<const Program>> compile(const std::string& literal,
+                                               const std::string& flags);
+
+/// @brief Calls `fn` for each successive non-overlapping match in `text`. After an empty match the
+/// next one must be non-empty or start further on, like with `std::sregex_iterator`
+/// @throws std::regex_error see `Program::search`
+void for_each_match(const Program& program, std::string_view text,
+                    const std::function<void(const Captures&)>& fn);
+
+}  // namespace regex_engine
@@ -0,0 +1,84 @@
+// resolver.h
+// Declares: Resolver
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ast.h"
+
+namespace resolver {
+
+/// @brief Resolves variable names to frame slots, so neither engine hashes names at runtime.
+/// Runs once on the output of `parser::Parser::parse()`.
+///
+/// A scope (script, function or block) gets a slot for every name assigned or declared by its own
+/// statements, plus the parameters for functions, unless an outer binding of the name is known to
+/// exist. Each reference then gets a single slot: the innermost one the name is already bound in,
+/// or else the innermost one it has. Inside a function, the global of that name takes precedence
+/// over a local that isn't bound yet. Parameters and declarations only bind within their own
+/// frame, so they shadow globals of the same name.
+///
+/// Block scopes don't get an environment of their own: their slots are laid out in the enclosing
+/// function's (or the script's) frame after the slots of the scopes around them, and sibling
+/// blocks share the same range
+class Resolver {
+   public:
+    /// @brief Fills in every `SlotRef` and `Block::num_slots` of the script
+    /// @param ast The parsed script, annotated in place
+    /// @return Number of slots the global scope needs
+    std::uint32_t resolve(Ast& ast);
+
+    /// @brief Number of distinct user function names seen by `resolve`. Definitions and calls of
+    /// a name share its number (`FunctionDef::function_id`, `CallTarget::id`), which is below
+    /// this count
+    std::uint32_t function_count() const noexcept {
+        return static_cast<std::uint32_t>(functions_.size());
+    }
+
+   private:
+    struct Scope {
+        /// enclosing block, or the global scope for function scopes
+        Scope* parent;
+        /// whether the scope starts a new frame (the script or a function)
+        bool is_frame;
+        std::unordered_map<std::string, std::uint32_t> slots;
+        /// names known to be bound for the rest of this scope's statements
+        std::unordered_set<std::string> bound;
+    };
+
+    void resolve_block(Block& block);
+    void resolve_function(Statement::FunctionDef& fd);
+    /// @brief Allocates a slot in the current scope if `s` assigns a name that isn't bound yet.
+    /// Called for each statement of a scope before any of them is resolved
+    void declare_local(StmtId id);
+    void resolve_statement(StmtId id);
+    void resolve_expr(ExprId id);
+
+    /// @brief Whether some binding of `name` is guaranteed to exist at the current point
+    bool is_bound(const std::string& name) const;
+    /// @brief Slot `name` refers to at the current point
+    /// @param frame_only Stop at the current frame, for declarations
+    /// @return The slot, or one with `SlotRef::UNBOUND` if no scope in reach assigns `name`
+    SlotRef lookup(const std::string& name, bool frame_only = false) const;
+    void declare(const std::string& name);
+    std::uint32_t function_id(const std::string& name);
+
+    struct Frame {
+        std::uint32_t next_slot = 0;
+        std::uint32_t num_slots = 0;
+    };
+
+    Ast* ast_ = nullptr;
+    Scope* global_ = nullptr;
+    Scope* current_ = nullptr;
+    Frame* frame_ = nullptr;
+    /// user function numbers, by name
+    std::unordered_map<std::string, std::uint32_t> functions_;
+};
+
+}  // namespace resolver
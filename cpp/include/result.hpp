@@ -4,12 +4,19 @@
 #pragma once
 
 #include <cassert>
-#include <memory>
 #include <type_traits>
+#include <utility>
 #include <variant>
 
 #include "errors.hpp"
+#include "shared.hpp"
 
+/// @brief Handle to the error of a failed `Result`: one pointer, and copying it while an error
+/// propagates up the call chain only bumps a plain counter
+using ErrorPtr = Shared<Error>;
+
+/// @brief Either a value or an error. The success path holds the value inline; take it out with
+/// `std::move(result).value()` to move it rather than copy it
 template <typename T>
 class Result {
    public:
@@ -22,7 +29,7 @@ class Result {
     Result& operator=(Result&&) = default;
 
     explicit Result(T v) : data_(std::move(v)) {}
-    explicit Result(std::shared_ptr<Error> e) : data_(std::move(e)) {}
+    explicit Result(ErrorPtr e) : data_(std::move(e)) {}
 
     /// @brief Checks if the Result contains a valid value (not an error)
     /// @return true if Result holds a value, false if it holds an error
@@ -32,7 +39,7 @@ class Result {
     /// @brief Checks if the Result contains an error (not a valid value)
     /// @return true if Result holds an error, false if it holds a value
     bool is_err() const noexcept {
-        return std::holds_alternative<std::shared_ptr<Error>>(data_);
+        return std::holds_alternative<ErrorPtr>(data_);
     }
 
     /// @brief gets Value. Asserts Result is ok first
@@ -47,25 +54,25 @@ class Result {
         return std::get<T>(data_);
     }
 
-    /// @brief gets Value. Asserts Result is ok first
+    /// @brief Moves the value out. Asserts Result is ok first
     T&& value() && {
         assert(is_ok());
         return std::get<T>(std::move(data_));
     }
 
     /// @brief Gets the error from the Result. Assumes Result contains an error
-    /// @return Reference to the shared_ptr containing the Error
-    std::shared_ptr<Error>& error() & {
-        return std::get<std::shared_ptr<Error>>(data_);
+    /// @return Reference to the handle of the Error
+    ErrorPtr& error() & {
+        return std::get<ErrorPtr>(data_);
     }
     /// @brief Gets the error from the Result (const version). Assumes Result contains an error
-    /// @return Const reference to the shared_ptr containing the Error
-    const std::shared_ptr<Error>& error() const& {
-        return std::get<std::shared_ptr<Error>>(data_);
+    /// @return Const reference to the handle of the Error
+    const ErrorPtr& error() const& {
+        return std::get<ErrorPtr>(data_);
     }
 
    private:
-    std::variant<T, std::shared_ptr<Error>> data_;
+    std::variant<T, ErrorPtr> data_;
 };
 
 template <typename T>
@@ -74,7 +81,7 @@ inline Result<T> ok(T value) {
 }
 
 template <typename T>
-inline Result<T> err(std::shared_ptr<Error> e) {
+inline Result<T> err(ErrorPtr e) {
     return Result<T>(std::move(e));
 }
 
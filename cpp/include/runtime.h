@@ -1,13 +1,15 @@
 // runtime.h
-// Declares: ExecFlow, Environment, MethodRepr, Interpreter
+// Declares: ExecFlow, Environment, Engine, ExecStats, Interpreter
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <optional>
 #include <string>
-#include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -37,54 +39,95 @@ struct ExecFlow {
 
 struct Environment;
 using env_ptr = std::shared_ptr<Environment>;
-struct Environment : public std::enable_shared_from_this<Environment> {
-    std::unordered_map<std::string, RuntimeValue> variables;
+/// @brief Variables of one frame (the script or a function call), stored in the slots assigned by
+/// `resolver::Resolver`. Block scopes use slot ranges of their frame. An empty slot means the
+/// variable hasn't been assigned in its scope
+struct Environment {
+    std::vector<std::optional<RuntimeValue>> slots;
     env_ptr parent = nullptr;
 
-    Environment() {
-        variables = std::unordered_map<std::string, RuntimeValue>();
-    };
-    Environment(env_ptr _parent) : parent(_parent) {
-        variables = std::unordered_map<std::string, RuntimeValue>();
-    };
+    Environment() = default;
+    Environment(std::size_t num_slots, env_ptr _parent = nullptr)
+        : slots(num_slots), parent(std::move(_parent)) {};
 
-    /// @brief Retrieves a variable by name, checking parent scopes if not found locally
-    /// @param name The variable name to look up
-    /// @return Optional containing the RuntimeValue if found, or nullopt if not found in any scope
-    std::optional<RuntimeValue> get(const std::string& name);
-    /// @brief Sets a variable in the current environment scope
-    /// @param name The variable name to set
+    /// @brief Retrieves a variable through its resolved slot
+    /// @param ref Slot of the variable
+    /// @return Pointer to the value in the slot, or nullptr if the variable is undefined. Valid
+    /// until the next `set` on this scope chain
+    RuntimeValue* get(SlotRef ref);
+    /// @brief Assigns a variable through its resolved slot
+    /// @param ref Slot of the variable; never `SlotRef::UNBOUND`
     /// @param value The RuntimeValue to assign to the variable
-    void set(const std::string& name, const RuntimeValue& value);
+    void set(SlotRef ref, RuntimeValue value);
+    /// @brief Empties the slot range of a block scope before the block is entered
+    /// @param first First slot of the range
+    /// @param count Number of slots in the range
+    void clear_slots(std::uint32_t first, std::uint32_t count);
+
+   private:
+    Environment& ancestor(std::uint32_t depth);
 };
 
-struct MethodRepr {
-    std::vector<std::pair<std::string, AstType>> args;
-    AstType returnType = astCreateNull();
-    std::vector<Statement> body;
+/// @brief Execution strategy used by `Interpreter::run`
+enum class Engine {
+    /// Walks the AST directly. Kept as the reference implementation for differential testing
+    TreeWalker,
+    /// Compiles the AST to register bytecode and executes it on `vm::VM`
+    Bytecode,
+};
+
+/// @brief Counters collected while a script runs, printed by `--stats`
+struct ExecStats {
+    /// environments heap-allocated; frames reused from the pool aren't counted
+    std::size_t scope_allocations = 0;
 };
 
 struct Interpreter {
     env_ptr global_env = std::make_shared<Environment>();
-    std::unordered_map<std::string, MethodRepr> functions;
+    /// script being executed by `run`
+    const Ast* ast = nullptr;
+    /// user functions by `FunctionDef::function_id`, pointing into `ast`; null until the
+    /// definition has run
+    std::vector<const Statement::FunctionDef*> functions;
     builtins::Logger logger;
     builtins::Console console;
     builtins::Clipboard clipboard;
     builtins::Alert alert;
+    Engine engine = Engine::Bytecode;
+    ExecStats stats;
+    /// frames of returned function calls, reused by `acquire_frame`
+    std::vector<env_ptr> free_frames;
 
-    /// @brief Executes a list of statements and returns the final result
-    /// @param stmts Vector of statements to execute
+    /// @brief Executes a script with the selected `engine` and returns the final result
+    /// @param ast The script, annotated by `resolver::Resolver`; must outlive the call
+    /// @param global_slots Number of global slots, as returned by `resolver::Resolver::resolve`
     /// @return Result containing the final RuntimeValue, or an error if execution failed
-    Result<RuntimeValue> run(const std::vector<Statement>& stmts);
+    Result<RuntimeValue> run(const Ast& ast, std::uint32_t global_slots);
     /// @brief Evaluates a sequence of statements in a given environment, handling control flow
-    /// @param stmts Vector of statements to evaluate
+    /// @param stmts Ids of the statements to evaluate, in order
     /// @param env The environment to execute in (handles variable scoping)
     /// @return Result containing ExecFlow indicating normal completion, return, break, or continue
-    Result<ExecFlow> eval_statements(const std::vector<Statement>& stmts, Environment& env);
-    Result<ExecFlow> eval_statements(const std::vector<StmtPtr>& stmts, Environment& env);
+    Result<ExecFlow> eval_statements(const std::vector<StmtId>& stmts, Environment& env);
+    /// @brief Evaluates a single statement in a given environment
+    /// @param id The statement to evaluate
+    /// @param env The environment to execute in
+    /// @return Result containing ExecFlow indicating normal completion, return, break, or continue
+    Result<ExecFlow> eval_statement(StmtId id, Environment& env);
+    /// @brief Evaluates a block's statements in the frame of the enclosing function or script
+    /// @param block The block to evaluate; its slots are cleared first
+    /// @param env Frame of the enclosing function or script
+    /// @return Result containing ExecFlow indicating normal completion, return, break, or continue
+    Result<ExecFlow> eval_block(const Block& block, Environment& env);
+    /// @brief Provides the frame for a function call, reusing a released one when possible
+    /// @param num_slots Slot count of the function's frame
+    /// @return Environment with `num_slots` empty slots whose parent is the global scope
+    env_ptr acquire_frame(std::size_t num_slots);
+    /// @brief Returns a function call's frame to the pool once the call has completed
+    /// @param env Frame obtained from `acquire_frame`
+    void release_frame(env_ptr env);
     /// @brief Evaluates a single expression to produce a RuntimeValue
-    /// @param expr The expression to evaluate
+    /// @param id The expression to evaluate
     /// @param env The environment to evaluate in (for variable lookups and scoping)
     /// @return Result containing the computed RuntimeValue, or an error if evaluation failed
-    Result<RuntimeValue> eval_expr(const Expr& expr, env_ptr env);
+    Result<RuntimeValue> eval_expr(ExprId id, Environment& env);
 };
\ No newline at end of file
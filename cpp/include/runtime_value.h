@@ -5,9 +5,13 @@
 
 #include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <variant>
 #include <vector>
 
+#include "shared.hpp"
+
 struct RegexType {
     std::string literal;
     std::string flags;
@@ -23,19 +27,49 @@ struct RuntimeValue {
     struct Bool {
         bool value;
     };
+    /// Contents are shared between copies and cloned on mutation (see `Shared`)
     struct String {
-        std::string value;
+        Shared<std::string> value;
     };
+    /// Elements are shared between copies and cloned on mutation (see `Shared`)
     struct List {
-        std::vector<RuntimeValue> values;
+        Shared<std::vector<RuntimeValue>> values;
     };
-    struct Match {
-        std::size_t start;
-        std::size_t end;
-        std::string content;
+    /// Refers to `[start, end)` of the string it was found in instead of copying the matched text;
+    /// `source` shares that string's buffer. The three fields sit behind one shared pointer to
+    /// keep the alternative 8 bytes wide
+    class Match {
+       public:
+        Match(std::size_t start, std::size_t end, Shared<std::string> source)
+            : data_(Data{start, end, std::move(source)}) {}
+
+        std::size_t start() const noexcept {
+            return data_->start;
+        }
+        std::size_t end() const noexcept {
+            return data_->end;
+        }
+        const Shared<std::string>& source() const noexcept {
+            return data_->source;
+        }
+
+        /// @brief The matched text, valid as long as this match is
+        std::string_view content() const noexcept {
+            return std::string_view(*data_->source).substr(start(), end() - start());
+        }
+
+       private:
+        struct Data {
+            std::size_t start;
+            std::size_t end;
+            Shared<std::string> source;
+        };
+
+        Shared<Data> data_;
     };
+    /// Shared between copies like string contents; a regex is never mutated
     struct Regex {
-        RegexType re;
+        Shared<RegexType> re;
     };
     struct Null {};
 
@@ -43,3 +77,6 @@ struct RuntimeValue {
 
     Variant value;
 };
+
+// Every alternative is at most one pointer wide, so a value is that plus the variant's index
+static_assert(sizeof(RuntimeValue) <= 16, "RuntimeValue should stay two words wide");
@@ -0,0 +1,42 @@
+// script_cache.h
+// Declares: cache_path, load, store
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "ast.h"
+
+/// @brief On-disk cache of parsed scripts, so running an unchanged script skips the lexer and
+/// parser. A cache file holds the `Ast` as `parser::Parser::parse()` returned it and
+/// `optimizer::Optimizer` simplified it, before `resolver::Resolver` annotated it; the resolver
+/// runs on every start and recomputes all bindings, slots and function ids.
+///
+/// Caches live in a directory of the user's own (see `cache_path`). A file is only used if it is
+/// ours and nobody else can write it, and its source hash, source size, interpreter version and
+/// format version all match; anything else (including a truncated or corrupt file) counts as a
+/// miss
+namespace script_cache {
+
+/// @brief Where the cache of a script lives: `$XDG_CACHE_HOME/copycleaner/` (`~/.cache` without
+/// it, `%LOCALAPPDATA%` on Windows), named after the script and a hash of its absolute path
+/// @return The path, or empty if there is no cache directory; `load` and `store` then do nothing
+std::string cache_path(const std::string& script_path);
+
+/// @brief Reads the cached AST of `source`
+/// @param path Cache file, see `cache_path`
+/// @param source Current contents of the script
+/// @return The AST, or nothing if the file is missing, stale or unreadable
+std::optional<Ast> load(const std::string& path, std::string_view source);
+
+/// @brief Writes the AST of `source` to the cache, creating its directory owner-only if needed.
+/// The file is replaced atomically, so a concurrent run never sees half of it
+/// @param path Cache file, see `cache_path`
+/// @param source Contents of the script `ast` was parsed from
+/// @param ast Output of `parser::Parser::parse()` and `optimizer::Optimizer`, not yet resolved
+/// @return Whether the file was written; failing is harmless, the next run just parses again
+bool store(const std::string& path, std::string_view source, const Ast& ast);
+
+}  // namespace script_cache
@@ -0,0 +1,42 @@
+// server.h
+// Declares: default_socket_path, serve, forward
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <vector>
+
+/// @brief Daemon mode: a resident `copycleaner --daemon` accepts runs over a Unix domain socket,
+/// so a hotkey's `copycleaner --client script.ccl` doesn't pay for parsing, resolving or regex
+/// compilation again.
+///
+/// The client sends its working directory, its arguments and its stdin/stdout/stderr descriptors;
+/// the daemon runs the script in a forked child with those descriptors in place of its own and
+/// replies with the exit code. A client that disconnects before then has its run killed, so a
+/// script that never finishes doesn't outlive it. Parsed scripts stay in memory keyed by absolute
+/// path and their regexes are compiled in the daemon, so every child inherits them; on Linux
+/// their files are watched with inotify and an edited script is reparsed as soon as it is saved,
+/// elsewhere on the first run after its size, modification time or inode changes. Only processes
+/// of the daemon's own user may connect, and clients only talk to a daemon of their own user.
+///
+/// Not available on Windows: `serve` fails and `forward` always reports no daemon
+namespace server {
+
+/// @brief `$XDG_RUNTIME_DIR/copycleaner.sock`, or `/tmp/copycleaner-<uid>/copycleaner.sock`
+/// without it
+std::string default_socket_path();
+
+/// @brief Listens on `socket_path` and serves runs until SIGINT or SIGTERM, which also ends the
+/// runs in progress. The socket's directory is created owner-only if missing, and must not belong
+/// to another user
+/// @return Exit code: 0 when stopped by a signal, 1 if the socket can't be set up
+int serve(const std::string& socket_path);
+
+/// @brief Runs a script on the daemon, with this process's working directory and standard streams
+/// @param socket_path Socket the daemon listens on
+/// @param args Arguments after the program name, without `--client` and `--socket=`
+/// @return The run's exit code, or nothing if no daemon of this user is listening
+std::optional<int> forward(const std::string& socket_path, const std::vector<std::string>& args);
+
+}  // namespace server
@@ -0,0 +1,75 @@
+// shared.hpp
+// Declares/Implements: Shared
+
+#pragma once
+
+#include <cstddef>
+#include <utility>
+
+/// @brief Reference-counted, copy-on-write holder for large runtime payloads (string and list
+/// contents, matches, regexes). Copying a `Shared` only bumps a reference count; the payload is
+/// cloned by `mut()` if it is still shared at the time it gets mutated.
+///
+/// A single pointer to one block holding the count and the payload, so a `RuntimeValue`
+/// alternative holding one stays 8 bytes. The count isn't atomic: runtime values never cross
+/// threads
+/// @tparam T Copy-constructible payload type
+template <typename T>
+class Shared {
+   public:
+    Shared() : block_(new Block{1, T()}) {}
+    Shared(T value) : block_(new Block{1, std::move(value)}) {}
+
+    Shared(const Shared& other) noexcept : block_(other.block_) {
+        ++block_->refs;
+    }
+    Shared(Shared&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+    Shared& operator=(const Shared& other) noexcept {
+        Shared(other).swap(*this);
+        return *this;
+    }
+    Shared& operator=(Shared&& other) noexcept {
+        Shared(std::move(other)).swap(*this);
+        return *this;
+    }
+    ~Shared() {
+        // A moved-from holder has no block
+        if (block_ && --block_->refs == 0) delete block_;
+    }
+
+    const T& operator*() const noexcept {
+        return block_->value;
+    }
+    const T* operator->() const noexcept {
+        return &block_->value;
+    }
+
+    /// @brief Gives write access to the payload, cloning it first if other holders share it
+    /// @return Payload owned by this holder alone
+    T& mut() {
+        if (block_->refs != 1) Shared(block_->value).swap(*this);
+        return block_->value;
+    }
+
+    /// @brief Checks whether this is the only holder, i.e. whether `mut()` is free
+    bool unique() const noexcept {
+        return block_->refs == 1;
+    }
+
+    /// @brief Compares payloads; holders sharing one payload are equal without comparing
+    friend bool operator==(const Shared& a, const Shared& b) {
+        return a.block_ == b.block_ || a.block_->value == b.block_->value;
+    }
+
+   private:
+    struct Block {
+        std::size_t refs;
+        T value;
+    };
+
+    void swap(Shared& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+    Block* block_;
+};
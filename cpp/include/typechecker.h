@@ -0,0 +1,75 @@
+// typechecker.h
+// Declares: TypeChecker
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ast.h"
+#include "errors.hpp"
+
+namespace typechecker {
+
+/// @brief Checks declared types before a script runs. Runs on the output of `resolver::Resolver`.
+///
+/// The type of an expression is inferred from literals, operators, casts, members, method results,
+/// declared return types and declared variable types. A variable's declared type is only relied on
+/// if every declaration of its name has that type and every value stored under the name is proven
+/// to match it, since assignments aren't checked at runtime.
+///
+/// Initializers, arguments of user function calls and returned values are then
+/// - reported if they can never match their declared type, even where they wouldn't run;
+/// - marked as proven (`VarDecl::initializer_proven`, `FunctionCall::args_proven`,
+///   `FunctionDef::returns_proven`) if they always match, so neither engine calls `matches_type`
+///   on them. Everything else is still checked at runtime
+class TypeChecker {
+   public:
+    /// @brief Checks the script and sets the `*_proven` flags of its nodes
+    /// @param ast The script, annotated by `resolver::Resolver`
+    /// @return Type errors in source order; the script must not run if there are any
+    std::vector<Error> check(Ast& ast);
+
+   private:
+    struct Declared {
+        AstType type;
+        /// whether every value stored under the name is proven to match `type`
+        bool reliable;
+    };
+
+    void collect_statement(StmtId id);
+    void collect_block(const Block& block);
+    void declare(const std::string& name, const AstType& type, bool has_value);
+    /// @brief Infers the type of every expression; children come before their parents
+    void infer_all();
+    /// @brief Infers the type of one expression from the inferred types of its children
+    std::optional<AstType> infer_expr(ExprId id) const;
+    std::optional<AstType> infer_method(const Expr::FunctionCall& fc) const;
+    std::optional<AstType> infer_call(const Expr::FunctionCall& fc) const;
+    /// @brief Whether the value of `id` always matches `type`, when it has one
+    bool proves(ExprId id, const AstType& type) const;
+
+    void check_statement(StmtId id);
+    void check_block(Block& block);
+    void check_expr(ExprId id);
+    /// @brief Records `message` if the value of `id` can never match `type`
+    void report_mismatch(ExprId id, const AstType& type, const char* message);
+
+    Ast* ast_ = nullptr;
+    std::unordered_map<std::string, Declared> declared_;
+    /// values stored by declarations and assignments, as (name, value)
+    std::vector<std::pair<std::string, ExprId>> stores_;
+    /// definitions of each user function, by `FunctionDef::function_id`
+    std::unordered_map<std::uint32_t, std::vector<const Statement::FunctionDef*>> functions_;
+    /// inferred type of each expression, by id
+    std::vector<std::optional<AstType>> types_;
+    /// function whose body is being checked, or nullptr at the top level
+    Statement::FunctionDef* function_ = nullptr;
+    std::vector<Error> errors_;
+};
+
+}  // namespace typechecker
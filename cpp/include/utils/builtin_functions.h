@@ -1,8 +1,11 @@
 // builtin_functions.h
-// Declares: call_builtin
+// Declares: BuiltinId, find_builtin, builtin_count, builtin_name, call_builtin
 
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -21,8 +24,34 @@ class Interpreter;
 /// @brief Built-in function dispatcher for CopyCleaner runtime
 namespace builtin_functions {
 
-/// @brief Dispatches and executes a built-in function by name
-/// @param name The name of the built-in function to call
+/// @brief Built-in functions handled by `call_builtin`. Script caches store these ids as numbers
+/// and are invalidated through a fingerprint of `builtin_name` by id (see script_cache.cpp)
+enum class BuiltinId : std::uint8_t {
+    FString,
+    SetLog,
+    Log,
+    Print,
+    ClipboardIsText,
+    ClipboardRead,
+    ClipboardWrite,
+    ShowAlertOK,
+    ShowAlert,
+    ShowAlertYesNoCancel,
+};
+
+/// @brief Looks up a built-in function; called once per call site by the parser
+/// @param name Function name as written in the script
+/// @return The built-in's id, or std::nullopt if `name` isn't a built-in function
+std::optional<BuiltinId> find_builtin(const std::string& name);
+
+/// @return Number of built-in functions; their ids are 0 to `builtin_count() - 1`
+std::size_t builtin_count();
+
+/// @return The name `id` is called by in scripts
+const char* builtin_name(BuiltinId id);
+
+/// @brief Executes a built-in function
+/// @param id The built-in function to call
 /// @param args The evaluated arguments to pass to the function
 /// @param logger Reference to the logger instance
 /// @param console Reference to the console instance
@@ -30,7 +59,7 @@ namespace builtin_functions {
 /// @param alert Reference to the alert instance
 /// @param interp Pointer to the interpreter (unused currently, reserved for future use)
 /// @return Result containing the return value or an error
-Result<RuntimeValue> call_builtin(const std::string& name, const std::vector<RuntimeValue>& args,
+Result<RuntimeValue> call_builtin(BuiltinId id, const std::vector<RuntimeValue>& args,
                                   builtins::Logger& logger, builtins::Console& console,
                                   builtins::Clipboard& clipboard, builtins::Alert& alert,
                                   Interpreter* interp);
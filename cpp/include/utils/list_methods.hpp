@@ -14,6 +14,9 @@ Result<RuntimeValue> get(const std::vector<RuntimeValue>& args);
 
 // List modification
 Result<RuntimeValue> push(const std::vector<RuntimeValue>& args);
+// Appends `value` to `list` itself; amortized O(1) when `list` holds the only reference to its
+// elements. Returns null
+Result<RuntimeValue> pushInPlace(RuntimeValue& list, RuntimeValue value);
 Result<RuntimeValue> slice(const std::vector<RuntimeValue>& args);
 
 // List search/query
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -8,8 +9,40 @@
 
 namespace MethodDispatcher {
 
-// Dispatch method calls to appropriate handler
-Result<RuntimeValue> dispatchMethod(const std::string& methodName,
+// Built-in methods, resolved from their names by the parser. Script caches store these ids as
+// numbers and are invalidated through a fingerprint of `methodName` by id (see script_cache.cpp)
+enum class MethodId : std::uint8_t {
+    Length,
+    Contains,
+    IndexOf,
+    ReplaceAll,
+    ToUpper,
+    ToLower,
+    Trim,
+    Substring,
+    Replace,
+    StartsWith,
+    EndsWith,
+    Split,
+    HasMatch,
+    ReplaceMatch,
+    Get,
+    Push,
+    Slice,
+    GetAll,
+    // Not a method; calls to it fail when they are executed
+    Unknown,
+};
+
+// Looks up a method by the name written after the '.'; MethodId::Unknown if there is none
+MethodId findMethod(const std::string& name);
+
+// The name a method is called by; empty for MethodId::Unknown
+const char* methodName(MethodId id);
+
+// Dispatch method calls to appropriate handler: one table lookup on (method, receiver type).
+// `args[0]` is the receiver; `methodName` is only used to report unknown methods
+Result<RuntimeValue> dispatchMethod(MethodId id, const std::string& methodName,
                                     const std::vector<RuntimeValue>& args);
 
 }  // namespace MethodDispatcher
@@ -1,12 +1,33 @@
 #pragma once
 
+#include "../regex_engine.h"
 #include "../result.hpp"
 #include "../runtime_value.h"
+#include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace RegexMethods {
 
 // Regex methods
 Result<RuntimeValue> getAll(const std::vector<RuntimeValue>& args);
+// regex.replaceAll(text, replacement): replaces every match in one pass. The replacement may
+// refer to the match with `$&`, to groups with `$1`..`$99`, to the text before/after it with
+// `` $` `` / `$'`; `$$` is a literal `$`
+Result<RuntimeValue> replaceAll(const std::vector<RuntimeValue>& args);
+
+// Compiled-program cache. Programs are shared by every regex value with the same literal and
+// flags; the least recently used one is evicted once CACHE_CAPACITY programs are held
+constexpr std::size_t CACHE_CAPACITY = 64;
+
+struct CacheStats {
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+};
+
+// Returns the compiled program for `re` (see regex_engine::compile), compiling it on a cache
+// miss. Invalid patterns are reported as runtime errors and are not cached
+Result<std::shared_ptr<const regex_engine::Program>> compile(const RegexType& re);
+CacheStats cacheStats();
 
 }  // namespace RegexMethods
@@ -1,6 +1,7 @@
 // runtime_utils.h
 // Declares: to_f64, numeric_add, numeric_sub, numeric_mul, numeric_div, numeric_pow, concat,
-// compare_gt, compare_lt, compare_ge, compare_le, eval_binary_op, cast_value, access_member
+// concat_in_place, compare_gt, compare_lt, compare_ge, compare_le, eval_unary_op, eval_binary_op,
+// cast_value, access_member
 
 #pragma once
 
@@ -21,12 +22,21 @@ Result<RuntimeValue> numeric_div(const RuntimeValue& l, const RuntimeValue& r);
 Result<RuntimeValue> numeric_pow(const RuntimeValue& l, const RuntimeValue& r);
 
 Result<RuntimeValue> concat(const RuntimeValue& l, const RuntimeValue& r);
+/// @brief Sets `l` to `l ++ r`, appending to the string in `l` itself; amortized O(|r|) when `l`
+/// holds the only reference to its contents
+void concat_in_place(RuntimeValue& l, const RuntimeValue& r);
 
 Result<RuntimeValue> compare_gt(const RuntimeValue& l, const RuntimeValue& r);
 Result<RuntimeValue> compare_lt(const RuntimeValue& l, const RuntimeValue& r);
 Result<RuntimeValue> compare_ge(const RuntimeValue& l, const RuntimeValue& r);
 Result<RuntimeValue> compare_le(const RuntimeValue& l, const RuntimeValue& r);
 
+/// @brief Evaluates a unary operation (`!` or numeric `-`) on a runtime value
+/// @param op The operator to apply (Operator::Not or Operator::Neg)
+/// @param operand The operand
+/// @return Result containing the computed value or an error
+Result<RuntimeValue> eval_unary_op(Operator op, const RuntimeValue& operand);
+
 /// @brief Evaluates a binary operation on two runtime values
 /// @param op The operator to apply
 /// @param left The left operand
@@ -15,6 +15,8 @@ Result<RuntimeValue> toLower(const std::vector<RuntimeValue>& args);
 Result<RuntimeValue> trim(const std::vector<RuntimeValue>& args);
 Result<RuntimeValue> substring(const std::vector<RuntimeValue>& args);
 Result<RuntimeValue> replace(const std::vector<RuntimeValue>& args);
+// string.replaceAll(regex, replacement), same as regex.replaceAll(string, replacement)
+Result<RuntimeValue> replaceAll(const std::vector<RuntimeValue>& args);
 
 // String search/query
 Result<RuntimeValue> contains(const std::vector<RuntimeValue>& args);
@@ -7,6 +7,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <variant>
 #include <vector>
 
@@ -55,12 +56,12 @@ inline bool operator==(const RuntimeValue& a, const RuntimeValue& b) {
         case 5: {  // Match
             const auto& l = std::get<RuntimeValue::Match>(a.value);
             const auto& r = std::get<RuntimeValue::Match>(b.value);
-            return l.start == r.start && l.end == r.end && l.content == r.content;
+            return l.start() == r.start() && l.end() == r.end() && l.content() == r.content();
         }
         case 6: {  // Regex
             const auto& l = std::get<RuntimeValue::Regex>(a.value);
             const auto& r = std::get<RuntimeValue::Regex>(b.value);
-            return l.re.flags == r.re.flags && l.re.literal == r.re.literal;
+            return l.re->flags == r.re->flags && l.re->literal == r.re->literal;
         }
         case 7:  // Null
             return true;
@@ -96,23 +97,24 @@ inline std::string to_string(const RuntimeValue& v) {
                 return val.value ? "true" : "false";
 
             else if constexpr (std::is_same_v<T, RuntimeValue::String>)
-                return val.value;
+                return *val.value;
 
             else if constexpr (std::is_same_v<T, RuntimeValue::List>) {
+                const auto& values = *val.values;
                 std::string out = "[";
-                for (std::size_t i = 0; i < val.values.size(); ++i) {
-                    out += to_string(val.values[i]);
-                    if (i + 1 < val.values.size()) out += ", ";
+                for (std::size_t i = 0; i < values.size(); ++i) {
+                    out += to_string(values[i]);
+                    if (i + 1 < values.size()) out += ", ";
                 }
                 out += "]";
                 return out;
             }
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Match>)
-                return val.content;
+                return std::string(val.content());
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Regex>)
-                return "/" + val.re.literal + "/" + val.re.flags;
+                return "/" + val.re->literal + "/" + val.re->flags;
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Null>)
                 return "null";
@@ -142,16 +144,16 @@ inline bool is_truthy(const RuntimeValue& v) {
                 return val.value != 0.0;
 
             else if constexpr (std::is_same_v<T, RuntimeValue::String>)
-                return !val.value.empty();
+                return !val.value->empty();
 
             else if constexpr (std::is_same_v<T, RuntimeValue::List>)
-                return !val.values.empty();
+                return !val.values->empty();
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Match>)
                 return true;
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Regex>)
-                return !val.re.literal.empty();
+                return !val.re->literal.empty();
 
             else if constexpr (std::is_same_v<T, RuntimeValue::Null>)
                 return false;
@@ -204,7 +206,7 @@ inline bool matches_type(const RuntimeValue& v, const AstType& t) {
                                        std::is_same_v<T, AstType::List>) {
                         // If the AST list type specifies an element type, ensure all elements match
                         // it
-                        const auto& rv = std::get<RuntimeValue::List>(v.value).values;
+                        const auto& rv = *std::get<RuntimeValue::List>(v.value).values;
                         if (!ty.element) return true;
                         const AstType& elem_type = *ty.element;
                         for (const auto& item : rv) {
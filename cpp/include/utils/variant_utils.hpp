@@ -1,8 +1,10 @@
 // variant_utils.hpp
-// Declares/Implements: overloaded
+// Declares/Implements: overloaded, variant_index
 
 #pragma once
 
+#include <cstddef>
+#include <type_traits>
 #include <variant>
 
 /// @brief helper for variant visit
@@ -14,3 +16,21 @@ struct overloaded : Ts... {
 
 template <class... Ts>
 overloaded(Ts...) -> overloaded<Ts...>;
+
+/// @brief Index of alternative `T` in the variant type `V`, as returned by `V::index()`
+template <class T, class V>
+struct variant_index;
+
+template <class T, class... Ts>
+struct variant_index<T, std::variant<Ts...>> {
+    static constexpr std::size_t value = [] {
+        constexpr bool matches[] = {std::is_same_v<T, Ts>...};
+        std::size_t i = 0;
+        while (i < sizeof...(Ts) && !matches[i]) ++i;
+        return i;
+    }();
+    static_assert(value < sizeof...(Ts), "T is not an alternative of V");
+};
+
+template <class T, class V>
+inline constexpr std::size_t variant_index_v = variant_index<T, V>::value;
@@ -0,0 +1,46 @@
+// vm.h
+// Declares: VM
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "bytecode.h"
+#include "result.hpp"
+#include "runtime.h"
+#include "runtime_value.h"
+
+namespace vm {
+
+/// @brief Executes a `bytecode::Program` with a single dispatch loop. User function calls push a
+/// frame instead of recursing on the C++ stack
+class VM {
+   public:
+    /// @param interp Interpreter providing the builtin modules and the global environment
+    explicit VM(Interpreter& interp);
+
+    /// @brief Runs the program's top-level body to completion
+    /// @param program Compiled program. Must outlive the call
+    /// @return Result containing the value of a top-level `return` (null otherwise), or an error
+    Result<RuntimeValue> run(const bytecode::Program& program);
+
+   private:
+    struct Frame {
+        std::uint32_t function;
+        std::size_t pc;
+        std::size_t base;
+        env_ptr env;
+        /// register in the caller's frame receiving the return value
+        std::uint32_t result_register;
+    };
+
+    Interpreter& interp_;
+    std::vector<RuntimeValue> registers_;
+    std::vector<Frame> frames_;
+    /// function index by function id (see `CallTarget`), NO_OPERAND until defined
+    std::vector<std::uint32_t> functions_;
+};
+
+}  // namespace vm
@@ -14,6 +14,7 @@
 namespace builtins {
 
 int Alert::show_dialog(const std::string& title, const std::string& message, int button_type) {
+    if (!enabled) return -1;
 #ifdef _WIN32
     UINT uType;
     switch (button_type) {
@@ -94,14 +95,14 @@ Result<RuntimeValue> Alert::show_ok(const std::string& title, const std::string&
     show_dialog(title, message, 0);
     RuntimeValue result;
     result.value = RuntimeValue::Null{};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> Alert::show_ok_cancel(const std::string& title, const std::string& message) {
     int dialog_result = show_dialog(title, message, 1);
     RuntimeValue result;
     result.value = RuntimeValue::Bool{dialog_result == 1};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> Alert::show_yes_no_cancel(const std::string& title,
@@ -109,7 +110,7 @@ Result<RuntimeValue> Alert::show_yes_no_cancel(const std::string& title,
     int dialog_result = show_dialog(title, message, 2);
     RuntimeValue result;
     result.value = RuntimeValue::Int{dialog_result};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 }  // namespace builtins
\ No newline at end of file
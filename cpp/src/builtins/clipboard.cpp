@@ -19,7 +19,7 @@ Result<RuntimeValue> Clipboard::is_text() {
     if (!OpenClipboard(nullptr)) {
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     bool has_text =
@@ -29,14 +29,14 @@ Result<RuntimeValue> Clipboard::is_text() {
 
     RuntimeValue result;
     result.value = RuntimeValue::Bool{has_text};
-    return ok(result);
+    return ok(std::move(result));
 #elif defined(__APPLE__)
     // Use pbpaste to check if clipboard has content
     FILE* pipe = popen("pbpaste", "r");
     if (!pipe) {
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     char buffer[128];
@@ -45,13 +45,13 @@ Result<RuntimeValue> Clipboard::is_text() {
 
     RuntimeValue result;
     result.value = RuntimeValue::Bool{has_content};
-    return ok(result);
+    return ok(std::move(result));
 #else
     // For other platforms, return false for now
     // TODO: Implement for Linux
     RuntimeValue result;
     result.value = RuntimeValue::Bool{false};
-    return ok(result);
+    return ok(std::move(result));
 #endif
 }
 
@@ -59,8 +59,8 @@ Result<RuntimeValue> Clipboard::read() {
 #ifdef _WIN32
     if (!OpenClipboard(nullptr)) {
         RuntimeValue result;
-        result.value = RuntimeValue::String{""};
-        return ok(result);
+        result.value = RuntimeValue::String{std::string()};
+        return ok(std::move(result));
     }
 
     std::string text;
@@ -94,14 +94,14 @@ Result<RuntimeValue> Clipboard::read() {
 
     RuntimeValue result;
     result.value = RuntimeValue::String{text};
-    return ok(result);
+    return ok(std::move(result));
 #elif defined(__APPLE__)
     // Use pbpaste to read clipboard
     FILE* pipe = popen("pbpaste", "r");
     if (!pipe) {
         RuntimeValue result;
-        result.value = RuntimeValue::String{""};
-        return ok(result);
+        result.value = RuntimeValue::String{std::string()};
+        return ok(std::move(result));
     }
 
     std::string text;
@@ -113,13 +113,13 @@ Result<RuntimeValue> Clipboard::read() {
 
     RuntimeValue result;
     result.value = RuntimeValue::String{text};
-    return ok(result);
+    return ok(std::move(result));
 #else
     // For other platforms, return empty string
     // TODO: Implement for Linux
     RuntimeValue result;
-    result.value = RuntimeValue::String{""};
-    return ok(result);
+    result.value = RuntimeValue::String{std::string()};
+    return ok(std::move(result));
 #endif
 }
 
@@ -128,7 +128,7 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
     if (!OpenClipboard(nullptr)) {
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     EmptyClipboard();
@@ -139,7 +139,7 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
         CloseClipboard();
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     HGLOBAL hMem = GlobalAlloc(GMEM_MOVEABLE, size * sizeof(wchar_t));
@@ -147,7 +147,7 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
         CloseClipboard();
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     wchar_t* pMem = static_cast<wchar_t*>(GlobalLock(hMem));
@@ -156,7 +156,7 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
         CloseClipboard();
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     MultiByteToWideChar(CP_UTF8, 0, message.c_str(), -1, pMem, size);
@@ -167,21 +167,21 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
         CloseClipboard();
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     CloseClipboard();
 
     RuntimeValue result;
     result.value = RuntimeValue::Bool{true};
-    return ok(result);
+    return ok(std::move(result));
 #elif defined(__APPLE__)
     // Use pbcopy to write to clipboard
     FILE* pipe = popen("pbcopy", "w");
     if (!pipe) {
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     size_t written = fwrite(message.c_str(), 1, message.length(), pipe);
@@ -191,13 +191,13 @@ Result<RuntimeValue> Clipboard::write(const std::string& message) {
 
     RuntimeValue result;
     result.value = RuntimeValue::Bool{success};
-    return ok(result);
+    return ok(std::move(result));
 #else
     // For other platforms, return false
     // TODO: Implement for Linux
     RuntimeValue result;
     result.value = RuntimeValue::Bool{false};
-    return ok(result);
+    return ok(std::move(result));
 #endif
 }
 
@@ -10,11 +10,11 @@ namespace builtins {
 Result<RuntimeValue> Console::print(const std::string& message) {
     // Print to stdout - does nothing if no console is available
     // (which is the expected behavior per the spec)
-    std::cout << message << std::endl;
+    if (enabled) std::cout << message << std::endl;
 
     RuntimeValue result;
     result.value = RuntimeValue::Null{};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 }  // namespace builtins
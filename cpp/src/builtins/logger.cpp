@@ -30,19 +30,25 @@ Result<RuntimeValue> Logger::set_log(const std::string& path) {
     if (!log_stream->is_open()) {
         RuntimeValue result;
         result.value = RuntimeValue::Bool{false};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     log_file_path = path;
 
     RuntimeValue result;
     result.value = RuntimeValue::Bool{true};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> Logger::log(const std::string& message) {
+    if (!enabled) {
+        RuntimeValue result;
+        result.value = RuntimeValue::Null{};
+        return ok(std::move(result));
+    }
+
     if (!log_file_path.has_value() || !log_stream || !log_stream->is_open()) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "No log file initialized. Call setLog() before logging.", ErrorKind::Runtime));
     }
 
@@ -69,7 +75,7 @@ Result<RuntimeValue> Logger::log(const std::string& message) {
 
     RuntimeValue result;
     result.value = RuntimeValue::Null{};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 bool Logger::has_log_file() const {
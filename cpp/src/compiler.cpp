@@ -0,0 +1,563 @@
+// compiler.cpp
+// Implements compiler.h
+
+#include "compiler.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "utils/method_dispatcher.hpp"
+
+using bytecode::Instruction;
+using bytecode::NO_OPERAND;
+using bytecode::OpCode;
+
+namespace compiler {
+
+/// @return Whether evaluating `id` may read variable `name`, directly or through a user function
+static bool may_read(const Ast& ast, ExprId id, const std::string& name) {
+    using E = Expr;
+    const Expr& expr = ast.expr(id);
+    auto reads = [&](ExprId sub) { return may_read(ast, sub, name); };
+
+    if (auto v = std::get_if<E::Variable>(&expr.value)) return v->name == name;
+    if (auto u = std::get_if<E::UnaryOp>(&expr.value)) return reads(u->next);
+    if (auto b = std::get_if<E::BinaryOp>(&expr.value)) return reads(b->left) || reads(b->right);
+    if (auto fc = std::get_if<E::FunctionCall>(&expr.value)) {
+        if (fc->target.kind == CallTarget::Kind::Function) return true;
+        return std::any_of(fc->args.begin(), fc->args.end(), reads);
+    }
+    if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        return reads(t->condition) || reads(t->then_expr) || reads(t->else_expr);
+    }
+    if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        return std::any_of(ll->elements.begin(), ll->elements.end(), reads);
+    }
+    if (auto tc = std::get_if<E::TypeCast>(&expr.value)) return reads(tc->expr);
+    if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) return reads(ma->object);
+    return false;
+}
+
+/// @return The int×int form of a generic arithmetic or comparison opcode, or `op` if it has none
+static OpCode int_form(OpCode op) {
+    switch (op) {
+        case OpCode::Add:
+            return OpCode::AddInt;
+        case OpCode::Sub:
+            return OpCode::SubInt;
+        case OpCode::Mul:
+            return OpCode::MulInt;
+        case OpCode::Eq:
+            return OpCode::EqInt;
+        case OpCode::Ne:
+            return OpCode::NeInt;
+        case OpCode::Gt:
+            return OpCode::GtInt;
+        case OpCode::Lt:
+            return OpCode::LtInt;
+        case OpCode::Ge:
+            return OpCode::GeInt;
+        case OpCode::Le:
+            return OpCode::LeInt;
+        default:
+            return op;
+    }
+}
+
+/// @return The float×float form of a generic arithmetic or comparison opcode, or `op` if it has
+/// none
+static OpCode float_form(OpCode op) {
+    switch (op) {
+        case OpCode::Add:
+            return OpCode::AddFloat;
+        case OpCode::Sub:
+            return OpCode::SubFloat;
+        case OpCode::Mul:
+            return OpCode::MulFloat;
+        case OpCode::Div:
+            return OpCode::DivFloat;
+        case OpCode::Eq:
+            return OpCode::EqFloat;
+        case OpCode::Ne:
+            return OpCode::NeFloat;
+        case OpCode::Gt:
+            return OpCode::GtFloat;
+        case OpCode::Lt:
+            return OpCode::LtFloat;
+        case OpCode::Ge:
+            return OpCode::GeFloat;
+        case OpCode::Le:
+            return OpCode::LeFloat;
+        default:
+            return op;
+    }
+}
+
+bytecode::Program Compiler::compile(const Ast& ast) {
+    ast_ = &ast;
+    program_ = bytecode::Program{};
+    name_ids_.clear();
+    global_kinds_.clear();
+    local_kinds_.clear();
+
+    program_.functions.push_back(
+        bytecode::FunctionProto{"<script>", {}, NO_OPERAND, false, 0, 0, {}});
+    FunctionState script{0, true, 0, {}};
+    current_ = &script;
+
+    for (auto id : ast.root) {
+        compile_statement(id);
+    }
+    emit(OpCode::ReturnNull);
+
+    current_ = nullptr;
+    ast_ = nullptr;
+    return std::move(program_);
+}
+
+void Compiler::compile_function(const Statement::FunctionDef& fd) {
+    auto index = static_cast<std::uint32_t>(program_.functions.size());
+    bytecode::FunctionProto proto;
+    proto.name = fd.name;
+    for (std::size_t i = 0; i < fd.params.size(); ++i) {
+        const auto& [pname, ptype] = fd.params[i];
+        proto.params.emplace_back(fd.param_slots[i], add_type(ptype));
+    }
+    proto.num_slots = fd.frame_slots;
+    if (fd.return_type.has_value()) {
+        proto.return_type = add_type(fd.return_type.value());
+        proto.returns_proven = fd.returns_proven;
+    }
+    program_.functions.push_back(std::move(proto));
+
+    // The body sees its parameters and the globals declared so far
+    auto outer_kinds = std::exchange(local_kinds_, std::vector<Kind>(fd.frame_slots, Kind::Other));
+    for (std::size_t i = 0; i < fd.params.size(); ++i) {
+        local_kinds_[fd.param_slots[i]] = kind_of(fd.params[i].second);
+    }
+
+    FunctionState* outer = current_;
+    FunctionState state{index, false, 0, {}};
+    current_ = &state;
+    for (auto id : fd.body.statements) {
+        compile_statement(id);
+    }
+    emit(OpCode::ReturnNull);
+    current_ = outer;
+    local_kinds_ = std::move(outer_kinds);
+
+    emit(OpCode::DefineFunction, index, fd.function_id);
+}
+
+void Compiler::compile_block(const Block& block) {
+    // Blocks that assign nothing need no scope at all
+    if (block.num_slots > 0) emit(OpCode::EnterBlock, block.first_slot, block.num_slots);
+    // Sibling blocks share slots; what an earlier one declared there doesn't apply
+    for (std::uint32_t i = 0; i < block.num_slots; ++i) {
+        declared(SlotRef{0, block.first_slot + i}) = Kind::Other;
+    }
+    for (auto id : block.statements) {
+        compile_statement(id);
+    }
+}
+
+void Compiler::compile_break_or_continue(bool is_break) {
+    if (current_->loops.empty()) {
+        // Outside of a loop the flow escapes to the caller, which rejects it
+        if (current_->is_script) {
+            emit(OpCode::Raise, add_error(is_break ? "invalid 'break' statement"
+                                                   : "invalid 'continue' statement",
+                                          ErrorKind::Syntax));
+        } else {
+            emit(OpCode::Raise,
+                 add_error("unexpected control flow in function body", ErrorKind::Runtime));
+        }
+        return;
+    }
+
+    Loop& loop = current_->loops.back();
+    if (is_break) {
+        loop.break_jumps.push_back(emit(OpCode::Jump));
+    } else {
+        emit(OpCode::Jump, static_cast<std::uint32_t>(loop.start));
+    }
+}
+
+bool Compiler::compile_push_assignment(const Statement::Assignment& a) {
+    auto fc = std::get_if<Expr::FunctionCall>(&ast_->expr(a.expr).value);
+    if (!fc || fc->target.kind != CallTarget::Kind::Method ||
+        fc->target.id != static_cast<std::uint32_t>(MethodDispatcher::MethodId::Push) ||
+        fc->args.size() != 2) {
+        return false;
+    }
+    auto receiver = std::get_if<Expr::Variable>(&ast_->expr(fc->args[0]).value);
+    if (!receiver || receiver->name != a.name) return false;
+    // The list is out of its slot while the pushed value is evaluated
+    if (may_read(*ast_, fc->args[1], a.name)) return false;
+
+    // Moving the list out of its slot leaves the register as its only holder, so the append
+    // doesn't copy. Evaluation order and errors are the same as for the method call
+    auto list = alloc_register();
+    emit(OpCode::TakeVar, list, add_variable(receiver->name, receiver->binding));
+    auto value = alloc_register();
+    compile_expr(fc->args[1], value);
+    emit(OpCode::ListPush, list, value);
+    emit(OpCode::StoreVar, add_variable(a.name, a.target), list);
+    free_register(list);
+    return true;
+}
+
+bool Compiler::compile_concat_assignment(const Statement::Assignment& a) {
+    // `x ++ a ++ b` is `(x ++ a) ++ b`: walk down the left operands to `x`, collecting the
+    // appended operands from last to first
+    std::vector<ExprId> appended;
+    ExprId left = a.expr;
+    while (auto b = std::get_if<Expr::BinaryOp>(&ast_->expr(left).value)) {
+        if (b->op != Operator::Concat) return false;
+        appended.push_back(b->right);
+        left = b->left;
+    }
+    auto target = std::get_if<Expr::Variable>(&ast_->expr(left).value);
+    if (appended.empty() || !target || target->name != a.name) return false;
+    // The string is out of its slot while the operands are evaluated
+    for (auto operand : appended) {
+        if (may_read(*ast_, operand, a.name)) return false;
+    }
+
+    // As in `compile_push_assignment`, the register is left as the string's only holder, so each
+    // operand is appended to it instead of the whole string being copied
+    auto str = alloc_register();
+    emit(OpCode::TakeVar, str, add_variable(target->name, target->binding));
+    auto value = alloc_register();
+    for (auto it = appended.rbegin(); it != appended.rend(); ++it) {
+        compile_expr(*it, value);
+        emit(OpCode::StringAppend, str, value);
+    }
+    emit(OpCode::StoreVar, add_variable(a.name, a.target), str);
+    free_register(str);
+    return true;
+}
+
+void Compiler::compile_statement(StmtId id) {
+    const Statement& s = ast_->stmt(id);
+    // Assignment
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
+        if (compile_push_assignment(*a) || compile_concat_assignment(*a)) return;
+        auto reg = alloc_register();
+        compile_expr(a->expr, reg);
+        emit(OpCode::StoreVar, add_variable(a->name, a->target), reg);
+        free_register(reg);
+        return;
+    }
+
+    // Variable Declaration
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
+        auto reg = alloc_register();
+        if (vd->initializer.has_value()) {
+            compile_expr(*vd->initializer, reg);
+            if (!vd->initializer_proven) {
+                emit(OpCode::TypeCheck, reg, add_type(vd->type),
+                     add_error("initializer type does not match declared type", ErrorKind::Type));
+            }
+        } else {
+            emit(OpCode::LoadConst, reg, add_constant(RuntimeValue{RuntimeValue::Null{}}));
+        }
+        emit(OpCode::StoreVar, add_variable(vd->name, vd->target), reg);
+        free_register(reg);
+        declared(vd->target) = kind_of(vd->type);
+        return;
+    }
+
+    // If / elif / else
+    if (auto i = std::get_if<Statement::If>(&s.value)) {
+        std::vector<std::size_t> end_jumps;
+        auto reg = alloc_register();
+
+        compile_expr(i->condition, reg);
+        auto next = emit(OpCode::JumpIfFalse, reg);
+        compile_block(i->body);
+        end_jumps.push_back(emit(OpCode::Jump));
+        patch_jump(next, here());
+
+        for (const auto& [cond, body] : i->elif) {
+            compile_expr(cond, reg);
+            next = emit(OpCode::JumpIfFalse, reg);
+            compile_block(body);
+            end_jumps.push_back(emit(OpCode::Jump));
+            patch_jump(next, here());
+        }
+
+        compile_block(i->else_body);
+        for (auto j : end_jumps) patch_jump(j, here());
+        free_register(reg);
+        return;
+    }
+
+    // While
+    if (auto w = std::get_if<Statement::While>(&s.value)) {
+        auto reg = alloc_register();
+        std::size_t start = here();
+        compile_expr(w->condition, reg);
+        auto exit_jump = emit(OpCode::JumpIfFalse, reg);
+
+        current_->loops.push_back(Loop{start, {}});
+        compile_block(w->body);
+        emit(OpCode::Jump, static_cast<std::uint32_t>(start));
+
+        Loop loop = std::move(current_->loops.back());
+        current_->loops.pop_back();
+        patch_jump(exit_jump, here());
+        for (auto j : loop.break_jumps) patch_jump(j, here());
+        free_register(reg);
+        return;
+    }
+
+    // Return
+    if (auto r = std::get_if<Statement::Return>(&s.value)) {
+        auto reg = alloc_register();
+        compile_expr(r->value, reg);
+        emit(OpCode::Return, reg);
+        free_register(reg);
+        return;
+    }
+
+    if (std::holds_alternative<Statement::Break>(s.value)) {
+        compile_break_or_continue(true);
+        return;
+    }
+
+    if (std::holds_alternative<Statement::Continue>(s.value)) {
+        compile_break_or_continue(false);
+        return;
+    }
+
+    if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
+        compile_function(*fd);
+        return;
+    }
+
+    // Expression statement, result is discarded
+    if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
+        auto reg = alloc_register();
+        compile_expr(es->expr, reg);
+        free_register(reg);
+        return;
+    }
+}
+
+Compiler::Kind Compiler::compile_expr(ExprId id, std::uint32_t dst) {
+    using E = Expr;
+    const Expr& expr = ast_->expr(id);
+
+    if (auto lit = std::get_if<E::Literal>(&expr.value)) {
+        emit(OpCode::LoadConst, dst, add_constant(lit->value));
+        if (std::holds_alternative<RuntimeValue::Int>(lit->value.value)) return Kind::Int;
+        if (std::holds_alternative<RuntimeValue::Float>(lit->value.value)) return Kind::Float;
+        return Kind::Other;
+    }
+
+    if (auto v = std::get_if<E::Variable>(&expr.value)) {
+        emit(OpCode::LoadVar, dst, add_variable(v->name, v->binding));
+        return v->binding.slot != SlotRef::UNBOUND ? declared(v->binding) : Kind::Other;
+    }
+
+    if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        Kind kind = compile_expr(u->next, dst);
+        emit(u->op == Operator::Not ? OpCode::Not : OpCode::Neg, dst, dst);
+        return u->op == Operator::Not ? Kind::Other : kind;
+    }
+
+    if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        // Logical operators short-circuit and always produce a bool
+        if (b->op == Operator::And || b->op == Operator::Or) {
+            compile_expr(b->left, dst);
+            emit(OpCode::ToBool, dst, dst);
+            auto skip = emit(b->op == Operator::And ? OpCode::JumpIfFalse : OpCode::JumpIfTrue, dst);
+            compile_expr(b->right, dst);
+            emit(OpCode::ToBool, dst, dst);
+            patch_jump(skip, here());
+            return Kind::Other;
+        }
+
+        Kind left = compile_expr(b->left, dst);
+        auto rhs = alloc_register();
+        Kind right = compile_expr(b->right, rhs);
+        OpCode op;
+        switch (b->op) {
+            case Operator::Add:
+                op = OpCode::Add;
+                break;
+            case Operator::Sub:
+                op = OpCode::Sub;
+                break;
+            case Operator::Mul:
+                op = OpCode::Mul;
+                break;
+            case Operator::Div:
+                op = OpCode::Div;
+                break;
+            case Operator::Pow:
+                op = OpCode::Pow;
+                break;
+            case Operator::Eq:
+                op = OpCode::Eq;
+                break;
+            case Operator::Ne:
+                op = OpCode::Ne;
+                break;
+            case Operator::Gt:
+                op = OpCode::Gt;
+                break;
+            case Operator::Lt:
+                op = OpCode::Lt;
+                break;
+            case Operator::Ge:
+                op = OpCode::Ge;
+                break;
+            case Operator::Le:
+                op = OpCode::Le;
+                break;
+            default:
+                op = OpCode::Concat;
+                break;
+        }
+        if (left == Kind::Int && right == Kind::Int) {
+            op = int_form(op);
+        } else if (left == Kind::Float && right == Kind::Float) {
+            op = float_form(op);
+        }
+        emit(op, dst, dst, rhs);
+        free_register(rhs);
+        // Comparisons produce bools, and int division and powers can't be assumed to stay ints
+        if (op >= OpCode::AddInt && op <= OpCode::MulInt) return Kind::Int;
+        if (op >= OpCode::AddFloat && op <= OpCode::DivFloat) return Kind::Float;
+        return Kind::Other;
+    }
+
+    if (auto fc = std::get_if<E::FunctionCall>(&expr.value)) {
+        auto argc = static_cast<std::uint32_t>(fc->args.size());
+        std::uint32_t base = current_->next_register;
+        for (std::uint32_t i = 0; i < argc; ++i) {
+            compile_expr(fc->args[i], alloc_register());
+        }
+        auto site = static_cast<std::uint32_t>(program_.call_sites.size());
+        program_.call_sites.push_back(
+            bytecode::CallSite{fc->name, argc, fc->target, fc->args_proven});
+        emit(OpCode::Call, dst, site, base);
+        current_->next_register = base;
+        return Kind::Other;
+    }
+
+    if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        compile_expr(t->condition, dst);
+        auto else_jump = emit(OpCode::JumpIfFalse, dst);
+        Kind then_kind = compile_expr(t->then_expr, dst);
+        auto end_jump = emit(OpCode::Jump);
+        patch_jump(else_jump, here());
+        Kind else_kind = compile_expr(t->else_expr, dst);
+        patch_jump(end_jump, here());
+        return then_kind == else_kind ? then_kind : Kind::Other;
+    }
+
+    if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        auto count = static_cast<std::uint32_t>(ll->elements.size());
+        std::uint32_t base = current_->next_register;
+        for (auto elem : ll->elements) {
+            compile_expr(elem, alloc_register());
+        }
+        emit(OpCode::NewList, dst, base, count);
+        current_->next_register = base;
+        return Kind::Other;
+    }
+
+    if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        compile_expr(tc->expr, dst);
+        emit(OpCode::Cast, dst, dst, add_type(tc->target_type));
+        return kind_of(tc->target_type);
+    }
+
+    if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        compile_expr(ma->object, dst);
+        emit(OpCode::GetMember, dst, dst, add_name(ma->member));
+        return Kind::Other;
+    }
+    return Kind::Other;
+}
+
+Compiler::Kind Compiler::kind_of(const AstType& type) {
+    if (std::holds_alternative<AstType::Int>(type.value)) return Kind::Int;
+    if (std::holds_alternative<AstType::Float>(type.value)) return Kind::Float;
+    return Kind::Other;
+}
+
+Compiler::Kind& Compiler::declared(SlotRef ref) {
+    // Depth 0 is the script frame in the script body, and depth 1 is only seen from functions
+    auto& kinds = current_->is_script || ref.depth > 0 ? global_kinds_ : local_kinds_;
+    if (kinds.size() <= ref.slot) kinds.resize(ref.slot + 1, Kind::Other);
+    return kinds[ref.slot];
+}
+
+std::uint32_t Compiler::alloc_register() {
+    auto reg = current_->next_register++;
+    auto& proto = program_.functions[current_->index];
+    proto.num_registers = std::max(proto.num_registers, current_->next_register);
+    return reg;
+}
+
+void Compiler::free_register(std::uint32_t reg) {
+    // Registers are allocated like a stack, so freeing releases everything above `reg` too
+    current_->next_register = reg;
+}
+
+std::size_t Compiler::emit(OpCode op, std::uint32_t a, std::uint32_t b, std::uint32_t c) {
+    code().push_back(Instruction{op, a, b, c});
+    return code().size() - 1;
+}
+
+std::size_t Compiler::here() const {
+    return program_.functions[current_->index].code.size();
+}
+
+void Compiler::patch_jump(std::size_t at, std::size_t target) {
+    Instruction& ins = code()[at];
+    if (ins.op == OpCode::Jump) {
+        ins.a = static_cast<std::uint32_t>(target);
+    } else {
+        ins.b = static_cast<std::uint32_t>(target);
+    }
+}
+
+std::vector<Instruction>& Compiler::code() {
+    return program_.functions[current_->index].code;
+}
+
+std::uint32_t Compiler::add_constant(RuntimeValue value) {
+    program_.constants.push_back(std::move(value));
+    return static_cast<std::uint32_t>(program_.constants.size() - 1);
+}
+
+std::uint32_t Compiler::add_name(const std::string& name) {
+    auto it = name_ids_.find(name);
+    if (it != name_ids_.end()) return it->second;
+    auto id = static_cast<std::uint32_t>(program_.names.size());
+    program_.names.push_back(name);
+    name_ids_.emplace(name, id);
+    return id;
+}
+
+std::uint32_t Compiler::add_variable(const std::string& name, SlotRef binding) {
+    program_.variables.push_back(bytecode::Variable{name, binding});
+    return static_cast<std::uint32_t>(program_.variables.size() - 1);
+}
+
+std::uint32_t Compiler::add_type(const AstType& type) {
+    program_.types.push_back(type);
+    return static_cast<std::uint32_t>(program_.types.size() - 1);
+}
+
+std::uint32_t Compiler::add_error(const std::string& message, ErrorKind kind) {
+    program_.errors.emplace_back(message, kind);
+    return static_cast<std::uint32_t>(program_.errors.size() - 1);
+}
+
+}  // namespace compiler
@@ -0,0 +1,151 @@
+// driver.cpp
+// Implements driver.h
+
+#include "driver.h"
+
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include "lexer.h"
+#include "optimizer.h"
+#include "parser.h"
+#include "resolver.h"
+#include "script_cache.h"
+#include "typechecker.h"
+#include "utils/regex_methods.hpp"
+
+namespace driver {
+
+Result<Options> parse_args(const std::vector<std::string>& args) {
+    Options options;
+    for (const auto& arg : args) {
+        if (arg == "--engine=tree") {
+            options.engine = Engine::TreeWalker;
+        } else if (arg == "--engine=vm") {
+            options.engine = Engine::Bytecode;
+        } else if (arg == "--stats") {
+            options.print_stats = true;
+        } else if (arg == "--bench-lexer") {
+            options.bench_lexer = true;
+        } else if (arg == "--no-alerts" || arg == "-a") {
+            options.alerts = false;
+        } else if (arg == "--no-logs" || arg == "-l") {
+            options.logs = false;
+        } else if (arg == "--no-console" || arg == "-c") {
+            options.console = false;
+        } else if (arg == "--no-cache") {
+            options.use_cache = false;
+        } else if (arg == "--daemon") {
+            options.daemon = true;
+        } else if (arg == "--client") {
+            options.client = true;
+        } else if (arg.starts_with("--socket=")) {
+            options.socket_path = arg.substr(9);
+        } else if (options.filename.empty() && !arg.starts_with("--")) {
+            options.filename = arg;
+        } else {
+            return err<Options>(Error("Unknown argument '" + arg + "'", ErrorKind::Runtime));
+        }
+    }
+    return ok(std::move(options));
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program
+              << " [--engine=tree|vm] [--stats] [--no-cache] [--no-alerts] [--no-logs]"
+                 " [--no-console] [--bench-lexer] [--client] [--socket=PATH] <script.ccl>"
+              << std::endl;
+    std::cerr << "       " << program << " --daemon [--socket=PATH]" << std::endl;
+    std::cerr << "  Executes a CopyCleaner script file (.ccl)" << std::endl;
+}
+
+std::optional<Script> load_script(const std::string& filename, std::string_view source,
+                                  bool use_cache) {
+    // An unchanged script is loaded from its cache instead of being lexed and parsed again
+    std::string cache_path = script_cache::cache_path(filename);
+    std::optional<Ast> cached;
+    if (use_cache) cached = script_cache::load(cache_path, source);
+    Origin origin = cached ? Origin::DiskCache : Origin::Parsed;
+
+    if (!cached) {
+        lexer::Lexer lexer(source);
+        parser::Parser parser(lexer);
+        auto parse_result = parser.parse();
+
+        if (is_err(parse_result)) {
+            std::cerr << "Parse error: " << parse_result.error()->what() << std::endl;
+            if (parse_result.error()->span().has_value()) {
+                auto& span = parse_result.error()->span().value();
+                std::cerr << "  at line " << span.p1.line << ", column " << span.p1.column
+                          << std::endl;
+            }
+            return std::nullopt;
+        }
+        cached = std::move(parse_result).value();
+        optimizer::Optimizer optimizer;
+        optimizer.optimize(*cached);
+        if (use_cache) script_cache::store(cache_path, source, *cached);
+    }
+
+    // Name resolution
+    Script script{std::move(*cached), 0, origin};
+    resolver::Resolver resolver;
+    script.global_slots = resolver.resolve(script.ast);
+
+    // Type checking
+    typechecker::TypeChecker checker;
+    auto type_errors = checker.check(script.ast);
+    if (!type_errors.empty()) {
+        for (const auto& error : type_errors) {
+            std::cerr << "Type error: " << error.what() << std::endl;
+            if (error.span().has_value()) {
+                auto& span = error.span().value();
+                std::cerr << "  at line " << span.p1.line << ", column " << span.p1.column
+                          << std::endl;
+            }
+        }
+        return std::nullopt;
+    }
+    return script;
+}
+
+int run_script(const Script& script, const Options& options) {
+    Interpreter interpreter;
+    interpreter.engine = options.engine;
+    interpreter.alert.enabled = options.alerts;
+    interpreter.logger.enabled = options.logs;
+    interpreter.console.enabled = options.console;
+    auto exec_result = interpreter.run(script.ast, script.global_slots);
+
+    if (options.print_stats) {
+        const char* cache_status = !options.use_cache                 ? "off"
+                                   : script.origin == Origin::Parsed   ? "miss"
+                                   : script.origin == Origin::Resident ? "resident"
+                                                                       : "hit";
+        std::cerr << "script cache: " << cache_status << std::endl;
+        std::cerr << "scope allocations: " << interpreter.stats.scope_allocations << std::endl;
+        auto regex_stats = RegexMethods::cacheStats();
+        std::cerr << "regex cache: " << regex_stats.hits << " hits, " << regex_stats.misses
+                  << " misses" << std::endl;
+    }
+
+    if (is_err(exec_result)) {
+        auto& error = exec_result.error();
+        std::cerr << "Runtime error: " << error->what() << std::endl;
+        if (error->span().has_value()) {
+            auto& span = error->span().value();
+            std::cerr << "  at line " << span.p1.line << ", column " << span.p1.column << std::endl;
+        }
+
+        // Check if this is a graceful exit
+        if (error->kind() == ErrorKind::Exit) {
+            return 0;  // Program requested exit - not an error
+        }
+        return 3;
+    }
+
+    return 0;
+}
+
+}  // namespace driver
@@ -5,7 +5,8 @@
 
 #include <cctype>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <utility>
 
 namespace lexer {
 
@@ -74,10 +75,58 @@ Token Lexer::read_number(Pos start) {
     }
 
     size_t len = pos_ - start_idx;
-    auto lex = src_.substr(start_idx, len);
     Pos end{line_, column_};
-    Token t{is_float ? TokenKind::Float : TokenKind::Int, std::string(lex), Span{start, end}};
-    return t;
+    return Token{is_float ? TokenKind::Float : TokenKind::Int, src_.substr(start_idx, len),
+                 Span{start, end}};
+}
+
+/// @return The keyword token kind of `s`, or Identifier. Switches on length, then on the first
+/// character, so each identifier is compared against at most one keyword
+static TokenKind keyword_kind(std::string_view s) {
+    auto is = [&](std::string_view kw, TokenKind kind) {
+        return s == kw ? kind : TokenKind::Identifier;
+    };
+
+    switch (s.size()) {
+        case 2:
+            return is("if", TokenKind::KwIf);
+        case 4:
+            switch (s[0]) {
+                case 'e':
+                    return s[2] == 'i' ? is("elif", TokenKind::KwElif)
+                                       : is("else", TokenKind::KwElse);
+                case 't':
+                    return is("true", TokenKind::Bool);
+                default:
+                    return TokenKind::Identifier;
+            }
+        case 5:
+            switch (s[0]) {
+                case 'w':
+                    return is("while", TokenKind::KwWhile);
+                case 'b':
+                    return is("break", TokenKind::KwBreak);
+                case 'f':
+                    return is("false", TokenKind::Bool);
+                default:
+                    return TokenKind::Identifier;
+            }
+        case 6:
+            return is("return", TokenKind::KwReturn);
+        case 7:
+            return is("returns", TokenKind::KwReturns);
+        case 8:
+            switch (s[0]) {
+                case 'f':
+                    return is("function", TokenKind::KwFunction);
+                case 'c':
+                    return is("continue", TokenKind::KwContinue);
+                default:
+                    return TokenKind::Identifier;
+            }
+        default:
+            return TokenKind::Identifier;
+    }
 }
 
 Token Lexer::read_identifier_or_keyword(Pos start) {
@@ -85,26 +134,8 @@ Token Lexer::read_identifier_or_keyword(Pos start) {
     while (std::isalnum(static_cast<unsigned char>(peek(0))) || peek(0) == '_') next_char();
     size_t len = pos_ - start_idx;
     auto lex = src_.substr(start_idx, len);
-    std::string s(lex);
-
-    static const std::unordered_map<std::string, TokenKind> kw = {
-        {"function", TokenKind::KwFunction},
-        {"returns", TokenKind::KwReturns},
-        {"if", TokenKind::KwIf},
-        {"elif", TokenKind::KwElif},
-        {"else", TokenKind::KwElse},
-        {"while", TokenKind::KwWhile},
-        {"return", TokenKind::KwReturn},
-        {"break", TokenKind::KwBreak},
-        {"continue", TokenKind::KwContinue},
-        {"true", TokenKind::Bool},
-        {"false", TokenKind::Bool},
-    };
-
-    auto it = kw.find(s);
-    TokenKind kind = (it != kw.end()) ? it->second : TokenKind::Identifier;
     Pos end{line_, column_};
-    return Token{kind, std::string(lex), Span{start, end}};
+    return Token{keyword_kind(lex), lex, Span{start, end}};
 }
 
 bool Lexer::handle_escape_sequence(std::string& lex) {
@@ -157,36 +188,50 @@ bool Lexer::handle_escape_sequence(std::string& lex) {
     }
 }
 
+std::string_view Lexer::store(std::string lex) {
+    decoded_.push_back(std::move(lex));
+    return decoded_.back();
+}
+
 Token Lexer::read_string(Pos start) {
+    size_t start_idx = pos_;
     char quote = peek(0);
     // consume opening quote
     next_char();
+
+    // Most literals have no escapes and are returned as a view of the source. The first
+    // backslash switches to decoding into `lex`
+    bool decoding = false;
     std::string lex;
-    lex.push_back(quote);
 
     bool terminated = false;
     while (true) {
         char c = peek(0);
         if (c == '\0') break;  // unterminated
 
-        if (handle_escape_sequence(lex)) {
+        if (c == '\\' && !decoding) {
+            decoding = true;
+            lex.assign(src_.substr(start_idx, pos_ - start_idx));
+        }
+        if (decoding && handle_escape_sequence(lex)) {
             continue;
         }
 
         if (c == quote) {
             next_char();
-            lex.push_back(quote);
+            if (decoding) lex.push_back(quote);
             terminated = true;
             break;
         }
         // normal char
-        lex.push_back(c);
+        if (decoding) lex.push_back(c);
         next_char();
     }
 
     Pos end{line_, column_};
     auto kind = terminated ? TokenKind::String : TokenKind::Unknown;
-    return Token{kind, std::move(lex), Span{start, end}};
+    auto text = decoding ? store(std::move(lex)) : src_.substr(start_idx, pos_ - start_idx);
+    return Token{kind, text, Span{start, end}};
 }
 
 Token Lexer::read_regex(Pos start) {
@@ -216,7 +261,7 @@ Token Lexer::read_regex(Pos start) {
     auto lex = src_.substr(start_idx, len);
     Pos end{line_, column_};
     auto kind = terminated ? TokenKind::Regex : TokenKind::Unknown;
-    return Token{kind, std::string(lex), Span{start, end}};
+    return Token{kind, lex, Span{start, end}};
 }
 
 Token Lexer::read_backslash_regex(Pos start) {
@@ -262,7 +307,7 @@ Token Lexer::read_backslash_regex(Pos start) {
     auto lex = src_.substr(start_idx, len);
     Pos end{line_, column_};
     auto kind = terminated ? TokenKind::Regex : TokenKind::Unknown;
-    return Token{kind, std::string(lex), Span{start, end}};
+    return Token{kind, lex, Span{start, end}};
 }
 
 Token Lexer::read_operator_or_punct(Pos start) {
@@ -274,49 +319,49 @@ Token Lexer::read_operator_or_punct(Pos start) {
     if (c == '=' && n == '=') {
         next_char();
         next_char();
-        return Token{TokenKind::Eq, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Eq, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '!' && n == '=') {
         next_char();
         next_char();
-        return Token{TokenKind::Ne, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Ne, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '>' && n == '=') {
         next_char();
         next_char();
-        return Token{TokenKind::Ge, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Ge, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '<' && n == '=') {
         next_char();
         next_char();
-        return Token{TokenKind::Le, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Le, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '&' && n == '&') {
         next_char();
         next_char();
-        return Token{TokenKind::And, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::And, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '|' && n == '|') {
         next_char();
         next_char();
-        return Token{TokenKind::Or, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Or, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '*' && n == '*') {
         next_char();
         next_char();
-        return Token{TokenKind::Pow, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Pow, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
     if (c == '+' && n == '+') {
         next_char();
         next_char();
-        return Token{TokenKind::Concat, std::string(src_.substr(start_idx, 2)),
+        return Token{TokenKind::Concat, src_.substr(start_idx, 2),
                      Span{start, Pos{line_, column_}}};
     }
 
@@ -326,45 +371,45 @@ Token Lexer::read_operator_or_punct(Pos start) {
     auto lex = src_.substr(start_idx, 1);
     switch (c) {
         case '(':
-            return Token{TokenKind::LParen, std::string(lex), Span{start, end}};
+            return Token{TokenKind::LParen, lex, Span{start, end}};
         case ')':
-            return Token{TokenKind::RParen, std::string(lex), Span{start, end}};
+            return Token{TokenKind::RParen, lex, Span{start, end}};
         case '{':
-            return Token{TokenKind::LBrace, std::string(lex), Span{start, end}};
+            return Token{TokenKind::LBrace, lex, Span{start, end}};
         case '}':
-            return Token{TokenKind::RBrace, std::string(lex), Span{start, end}};
+            return Token{TokenKind::RBrace, lex, Span{start, end}};
         case '[':
-            return Token{TokenKind::LBracket, std::string(lex), Span{start, end}};
+            return Token{TokenKind::LBracket, lex, Span{start, end}};
         case ']':
-            return Token{TokenKind::RBracket, std::string(lex), Span{start, end}};
+            return Token{TokenKind::RBracket, lex, Span{start, end}};
         case ',':
-            return Token{TokenKind::Comma, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Comma, lex, Span{start, end}};
         case ';':
-            return Token{TokenKind::Semicolon, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Semicolon, lex, Span{start, end}};
         case '+':
-            return Token{TokenKind::Plus, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Plus, lex, Span{start, end}};
         case '-':
-            return Token{TokenKind::Minus, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Minus, lex, Span{start, end}};
         case '*':
-            return Token{TokenKind::Star, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Star, lex, Span{start, end}};
         case '/':
-            return Token{TokenKind::Slash, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Slash, lex, Span{start, end}};
         case '=':
-            return Token{TokenKind::Assign, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Assign, lex, Span{start, end}};
         case '>':
-            return Token{TokenKind::Gt, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Gt, lex, Span{start, end}};
         case '<':
-            return Token{TokenKind::Lt, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Lt, lex, Span{start, end}};
         case '!':
-            return Token{TokenKind::Not, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Not, lex, Span{start, end}};
         case '?':
-            return Token{TokenKind::Question, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Question, lex, Span{start, end}};
         case ':':
-            return Token{TokenKind::Colon, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Colon, lex, Span{start, end}};
         case '.':
-            return Token{TokenKind::Dot, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Dot, lex, Span{start, end}};
         default:
-            return Token{TokenKind::Unknown, std::string(lex), Span{start, end}};
+            return Token{TokenKind::Unknown, lex, Span{start, end}};
     }
 }
 
@@ -372,9 +417,9 @@ Result<Token> Lexer::next_token() {
     skip_whitespace_and_comments();
 
     if (eof()) {
-        Token t{TokenKind::EndOfFile, std::string(src_.substr(pos_, 0)),
+        Token t{TokenKind::EndOfFile, src_.substr(pos_, 0),
                 Span{Pos{line_, column_}, Pos{line_, column_}}};
-        return ok(t);
+        return ok(std::move(t));
     }
 
     Pos start{line_, column_};
@@ -410,8 +455,7 @@ Result<Token> Lexer::next_token() {
     if (c == '"' || c == '\'') {
         Token t = read_string(start);
         if (t.kind == TokenKind::Unknown) {
-            return err<Token>(
-                std::make_shared<Error>("Unterminated string literal", ErrorKind::Syntax));
+            return err<Token>(Error("Unterminated string literal", ErrorKind::Syntax));
         }
         return emit(std::move(t));
     }
@@ -464,8 +508,7 @@ Result<Token> Lexer::next_token() {
             if (found) {
                 Token t = read_backslash_regex(start);
                 if (t.kind == TokenKind::Unknown) {
-                    return err<Token>(
-                        std::make_shared<Error>("Unterminated regex literal", ErrorKind::Syntax));
+                    return err<Token>(Error("Unterminated regex literal", ErrorKind::Syntax));
                 }
                 return emit(std::move(t));
             }
@@ -520,8 +563,7 @@ Result<Token> Lexer::next_token() {
         if (found) {
             Token t = read_regex(start);
             if (t.kind == TokenKind::Unknown) {
-                return err<Token>(
-                    std::make_shared<Error>("Unterminated regex literal", ErrorKind::Syntax));
+                return err<Token>(Error("Unterminated regex literal", ErrorKind::Syntax));
             }
             return emit(std::move(t));
         }
@@ -1,71 +1,94 @@
 // main.cpp
 // Entry point for CopyCleaner interpreter
 
-#include <fstream>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
-#include <memory>
-#include <sstream>
 #include <string>
+#include <string_view>
+#include <vector>
 
+#include "driver.h"
 #include "lexer.h"
-#include "parser.h"
-#include "runtime.h"
+#include "mapped_file.h"
+#include "server.h"
 
-int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <script.ccl>" << std::endl;
-        std::cerr << "  Executes a CopyCleaner script file (.ccl)" << std::endl;
-        return 1;
-    }
+/// @brief Lexes `source` over and over for about a second and prints the token throughput
+/// @return Exit code: 0, or 2 if `source` doesn't lex
+static int run_lexer_benchmark(std::string_view source) {
+    using Clock = std::chrono::steady_clock;
+    std::size_t tokens = 0;
+    std::size_t passes = 0;
+    auto start = Clock::now();
+    std::chrono::duration<double> elapsed{};
+    do {
+        lexer::Lexer lexer(source);
+        while (true) {
+            auto token = lexer.next_token();
+            if (is_err(token)) {
+                std::cerr << "Lex error: " << token.error()->what() << std::endl;
+                return 2;
+            }
+            if (token.value().kind == lexer::TokenKind::EndOfFile) break;
+            ++tokens;
+        }
+        ++passes;
+        elapsed = Clock::now() - start;
+    } while (elapsed.count() < 1.0);
 
-    std::string filename = argv[1];
+    double seconds = elapsed.count();
+    auto tokens_per_second = static_cast<std::uint64_t>(tokens / seconds);
+    double megabytes_per_second = source.size() * passes / seconds / 1e6;
+    std::cout << "lexer: " << tokens << " tokens in " << passes << " passes, " << seconds << " s ("
+              << tokens_per_second << " tokens/s, " << megabytes_per_second << " MB/s)"
+              << std::endl;
+    return 0;
+}
 
-    // Read the script file
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open file '" << filename << "'" << std::endl;
+int main(int argc, char* argv[]) {
+    auto parsed = driver::parse_args(std::vector<std::string>(argv + 1, argv + argc));
+    if (is_err(parsed)) {
+        std::cerr << "Error: " << parsed.error()->what() << std::endl;
         return 1;
     }
+    const auto& options = parsed.value();
+    std::string socket_path =
+        options.socket_path.empty() ? server::default_socket_path() : options.socket_path;
 
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string source = buffer.str();
-    file.close();
-
-    lexer::Lexer lexer(source);
-    parser::Parser parser(lexer);
-    auto parse_result = parser.parse();
-
-    if (is_err(parse_result)) {
-        std::cerr << "Parse error: " << parse_result.error()->what() << std::endl;
-        if (parse_result.error()->span().has_value()) {
-            auto& span = parse_result.error()->span().value();
-            std::cerr << "  at line " << span.p1.line << ", column " << span.p1.column 
-                      << std::endl;
+    if (options.daemon) {
+        if (!options.filename.empty()) {
+            driver::print_usage(argv[0]);
+            return 1;
         }
-        return 2;
+        return server::serve(socket_path);
     }
 
-    // Execution
-    auto statements = std::move(parse_result).value();
-    Interpreter interpreter;
-    auto global_env = std::make_shared<Environment>(nullptr);
-    auto exec_result = interpreter.eval_statements(statements, *global_env);
+    if (options.filename.empty()) {
+        driver::print_usage(argv[0]);
+        return 1;
+    }
 
-    if (is_err(exec_result)) {
-        auto& error = exec_result.error();
-        std::cerr << "Runtime error: " << error->what() << std::endl;
-        if (error->span().has_value()) {
-            auto& span = error->span().value();
-            std::cerr << "  at line " << span.p1.line << ", column " << span.p1.column << std::endl;
+    // Hand the run to a resident daemon if one is listening, otherwise run it here
+    if (options.client && !options.bench_lexer) {
+        std::vector<std::string> args;
+        for (int i = 1; i < argc; ++i) {
+            std::string_view arg = argv[i];
+            if (arg != "--client" && !arg.starts_with("--socket=")) args.emplace_back(arg);
         }
+        if (auto code = server::forward(socket_path, args)) return *code;
+    }
 
-        // Check if this is a graceful exit
-        if (error->kind() == ErrorKind::Exit) {
-            return 0;  // Program requested exit - not an error
-        }
-        return 3;
+    // The script is mapped and lexed in place (see mapped_file.h)
+    MappedFile file(options.filename);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file '" << options.filename << "'" << std::endl;
+        return 1;
     }
 
-    return 0;
+    if (options.bench_lexer) return run_lexer_benchmark(file.view());
+
+    auto script = driver::load_script(options.filename, file.view(), options.use_cache);
+    if (!script) return 2;
+    return driver::run_script(*script, options);
 }
@@ -0,0 +1,100 @@
+// mapped_file.cpp
+// Implements mapped_file.h
+
+#include "mapped_file.h"
+
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& path, bool allow_mapping) {
+    if (allow_mapping && map(path)) {
+        open_ = true;
+        return;
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return;
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    buffered_ = std::move(contents).str();
+    data_ = buffered_.data();
+    size_ = buffered_.size();
+    open_ = true;
+}
+
+#ifdef _WIN32
+bool MappedFile::map(const std::string& path) {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    // Windows can't map an empty file; an empty view is all that's needed
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) return false;
+    // The view keeps the mapping alive after its handle is closed
+    void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!data) return false;
+
+    data_ = static_cast<const char*>(data);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    mapped_ = true;
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) UnmapViewOfFile(data_);
+}
+#else
+bool MappedFile::map(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    // mmap rejects a zero length; an empty view is all that's needed
+    if (st.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    auto size = static_cast<std::size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) return false;
+
+    data_ = static_cast<const char*>(data);
+    size_ = size;
+    mapped_ = true;
+    return true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapped_) munmap(const_cast<char*>(data_), size_);
+}
+#endif
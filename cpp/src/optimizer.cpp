@@ -0,0 +1,158 @@
+// optimizer.cpp
+// Implements optimizer.h
+
+#include "optimizer.h"
+
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include "utils/runtime_utils.h"
+#include "utils/types_utils.hpp"
+
+namespace optimizer {
+
+namespace {
+
+/// @return The value of a literal expression, or nullptr
+const RuntimeValue* literal_value(const Expr& expr) {
+    auto lit = std::get_if<Expr::Literal>(&expr.value);
+    return lit ? &lit->value : nullptr;
+}
+
+/// @return Whether a literal can hold `value`; lists and matches only exist at runtime
+bool is_literal_kind(const RuntimeValue& value) {
+    return !std::holds_alternative<RuntimeValue::List>(value.value) &&
+           !std::holds_alternative<RuntimeValue::Match>(value.value);
+}
+
+RuntimeValue make_bool(bool b) {
+    RuntimeValue value;
+    value.value = RuntimeValue::Bool{b};
+    return value;
+}
+
+}  // namespace
+
+void Optimizer::optimize(Ast& ast) {
+    ast_ = &ast;
+
+    // Children always have lower ids than their parents, so a single pass in id order folds
+    // bottom-up, and every statement sees its nested statements already simplified
+    for (ExprId id = 0; id < ast.exprs.size(); ++id) {
+        fold_expr(id);
+    }
+    dead_.assign(ast.stmts.size(), false);
+    for (StmtId id = 0; id < ast.stmts.size(); ++id) {
+        simplify_statement(id);
+    }
+    remove_dead(ast.root);
+
+    dead_.clear();
+    ast_ = nullptr;
+}
+
+void Optimizer::fold_expr(ExprId id) {
+    using E = Expr;
+
+    Expr& expr = ast_->expr(id);
+    std::optional<Result<RuntimeValue>> folded;
+
+    if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        if (auto operand = literal_value(ast_->expr(u->next))) {
+            folded = runtime_utils::eval_unary_op(u->op, *operand);
+        }
+    } else if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        const RuntimeValue* left = literal_value(ast_->expr(b->left));
+        const RuntimeValue* right = literal_value(ast_->expr(b->right));
+        if (b->op == Operator::And || b->op == Operator::Or) {
+            // The right operand only matters if the left one doesn't decide
+            bool is_and = b->op == Operator::And;
+            if (left && is_truthy(*left) != is_and) {
+                folded = ok(make_bool(!is_and));
+            } else if (left && right) {
+                folded = ok(make_bool(is_truthy(*right)));
+            }
+        } else if (left && right) {
+            folded = runtime_utils::eval_binary_op(b->op, *left, *right);
+        }
+    } else if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        if (auto operand = literal_value(ast_->expr(tc->expr))) {
+            folded = runtime_utils::cast_value(*operand, tc->target_type);
+        }
+    } else if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        if (auto object = literal_value(ast_->expr(ma->object))) {
+            folded = runtime_utils::access_member(*object, ma->member);
+        }
+    } else if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        if (auto condition = literal_value(ast_->expr(t->condition))) {
+            // The chosen branch's children have lower ids too, so the copy keeps the order
+            expr = ast_->expr(is_truthy(*condition) ? t->then_expr : t->else_expr);
+        }
+        return;
+    }
+
+    if (folded && is_ok(*folded) && is_literal_kind(folded->value())) {
+        expr.value = E::Literal{std::move(*folded).value()};
+    }
+}
+
+void Optimizer::simplify_statement(StmtId id) {
+    using S = Statement;
+
+    Statement& s = ast_->stmt(id);
+
+    if (auto es = std::get_if<S::ExpressionStmt>(&s.value)) {
+        dead_[id] = literal_value(ast_->expr(es->expr)) != nullptr;
+    } else if (auto w = std::get_if<S::While>(&s.value)) {
+        remove_dead(w->body.statements);
+        auto condition = literal_value(ast_->expr(w->condition));
+        dead_[id] = condition && !is_truthy(*condition);
+    } else if (auto i = std::get_if<S::If>(&s.value)) {
+        remove_dead(i->body.statements);
+        for (auto& [cond, body] : i->elif) remove_dead(body.statements);
+        remove_dead(i->else_body.statements);
+
+        // Drop the branches that can't be taken; the first one that always is becomes the else
+        std::vector<std::pair<ExprId, Block>> branches;
+        branches.emplace_back(i->condition, std::move(i->body));
+        for (auto& branch : i->elif) branches.push_back(std::move(branch));
+        Block otherwise = std::move(i->else_body);
+        std::optional<ExprId> always;
+        std::vector<std::pair<ExprId, Block>> kept;
+        for (auto& [cond, body] : branches) {
+            auto value = literal_value(ast_->expr(cond));
+            if (!value) {
+                kept.emplace_back(cond, std::move(body));
+            } else if (is_truthy(*value)) {
+                always = cond;
+                otherwise = std::move(body);
+                break;
+            }
+        }
+
+        if (!kept.empty()) {
+            ExprId condition = kept.front().first;
+            Block body = std::move(kept.front().second);
+            kept.erase(kept.begin());
+            s.value = S::If{condition, std::move(body), std::move(kept), std::move(otherwise)};
+        } else if (otherwise.statements.empty()) {
+            dead_[id] = true;
+        } else {
+            // Still a block of its own, so its variables keep their scope
+            if (!always) {
+                Span span = ast_->expr(i->condition).span;
+                always = ast_->add(Expr{span, Expr::Literal{make_bool(true)}});
+            }
+            s.value = S::If{*always, std::move(otherwise), {}, Block()};
+        }
+    } else if (auto fd = std::get_if<S::FunctionDef>(&s.value)) {
+        remove_dead(fd->body.statements);
+    }
+}
+
+void Optimizer::remove_dead(std::vector<StmtId>& statements) {
+    std::erase_if(statements, [this](StmtId id) { return dead_[id]; });
+}
+
+}  // namespace optimizer
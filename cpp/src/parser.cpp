@@ -3,13 +3,19 @@
 
 #include "parser.h"
 
+#include <cassert>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
 #include "ast.h"
 #include "errors.hpp"
 #include "lexer.h"
 #include "result.hpp"
+#include "utils/builtin_functions.h"
+#include "utils/method_dispatcher.hpp"
 
 using lexer::Lexer;
 using lexer::Token;
@@ -28,58 +34,59 @@ Parser::Parser(Lexer& lexer) : lexer_(lexer) {
     }
 }
 
-Result<std::vector<Statement>> Parser::parse() {
+Result<Ast> Parser::parse() {
     if (had_error_) {
-        return err<std::vector<Statement>>(
-            std::make_shared<Error>("Failed to initialize parser: lexer error", ErrorKind::Parse));
+        return err<Ast>(Error("Failed to initialize parser: lexer error", ErrorKind::Parse));
     }
-    std::vector<Statement> statements;
+    ast_ = Ast{};
 
     while (!check(TokenKind::EndOfFile)) {
         auto stmt = parse_statement();
         if (is_err(stmt)) {
-            return err<std::vector<Statement>>(stmt.error());
+            return err<Ast>(stmt.error());
         }
-        statements.push_back(std::move(stmt).value());
+        ast_.root.push_back(ast_.add(std::move(stmt).value()));
     }
 
-    return ok(std::move(statements));
+    return ok(std::move(ast_));
 }
 
 // Helper methods
-Token Parser::peek() {
+const Token& Parser::peek() {
     return current_;
 }
 
-Token Parser::peek_ahead(int offset) {
-    // Save current state
-    auto saved_lexer = lexer_;
-    Token saved_current = current_;
-    
-    // Advance by offset tokens
-    Token result = current_;
-    for (int i = 0; i < offset; ++i) {
+void Parser::fill_lookahead(std::size_t count) {
+    while (lookahead_count_ < count) {
+        Lookahead& slot = lookahead_[(lookahead_head_ + lookahead_count_) % LOOKAHEAD];
         auto next = lexer_.next_token();
-        if (is_ok(next)) {
-            result = next.value();
-        } else {
-            break;
-        }
+        slot.ok = is_ok(next);
+        if (slot.ok) slot.token = std::move(next).value();
+        ++lookahead_count_;
     }
-    
-    // Restore state
-    lexer_ = saved_lexer;
-    current_ = saved_current;
-    
-    return result;
 }
 
-Token Parser::advance() {
-    Token prev = current_;
-    auto result = lexer_.next_token();
-    if (is_ok(result)) {
-        current_ = result.value();
+const Token& Parser::peek_ahead(std::size_t offset) {
+    assert(offset <= LOOKAHEAD);
+    fill_lookahead(offset);
+    const Token* result = &current_;
+    for (std::size_t i = 0; i < offset; ++i) {
+        const Lookahead& next = lookahead_[(lookahead_head_ + i) % LOOKAHEAD];
+        if (!next.ok) break;
+        result = &next.token;
     }
+    return *result;
+}
+
+Token Parser::advance() {
+    fill_lookahead(1);
+    Lookahead& next = lookahead_[lookahead_head_];
+    lookahead_head_ = (lookahead_head_ + 1) % LOOKAHEAD;
+    --lookahead_count_;
+    // A token the lexer failed on is skipped, leaving the current token in place
+    if (!next.ok) return current_;
+    Token prev = std::move(current_);
+    current_ = std::move(next.token);
     return prev;
 }
 
@@ -95,11 +102,11 @@ bool Parser::match(TokenKind kind) {
     return false;
 }
 
-Result<Token> Parser::expect(TokenKind kind, const std::string& msg) {
+Result<Token> Parser::expect(TokenKind kind, std::string_view msg) {
     if (check(kind)) {
         return ok(advance());
     }
-    return err<Token>(std::make_shared<Error>(msg, current_.span, ErrorKind::Syntax));
+    return err<Token>(Error(std::string(msg), current_.span, ErrorKind::Syntax));
 }
 
 // Statement parsing
@@ -124,20 +131,20 @@ Result<Statement> Parser::parse_statement() {
         if (is_err(tok)) return err<Statement>(tok.error());
         Statement stmt;
         stmt.value = Statement::Break{};
-        return ok(stmt);
+        return ok(std::move(stmt));
     }
     if (match(TokenKind::KwContinue)) {
         auto tok = expect(TokenKind::Semicolon, "expected ';' after 'continue'");
         if (is_err(tok)) return err<Statement>(tok.error());
         Statement stmt;
         stmt.value = Statement::Continue{};
-        return ok(stmt);
+        return ok(std::move(stmt));
     }
 
     // Variable declaration or assignment
     if (check(TokenKind::Identifier)) {
         // Check if this is a type keyword (potential variable declaration)
-        std::string ident = peek().lexeme;
+        std::string_view ident = peek().lexeme;
         if (ident == "int" || ident == "float" || ident == "boolean" || 
             ident == "string" || ident == "regex" || ident == "match" || ident == "list") {
             return parse_var_declaration();
@@ -151,8 +158,7 @@ Result<Statement> Parser::parse_statement() {
         return parse_expression_statement();
     }
 
-    return err<Statement>(
-        std::make_shared<Error>("unexpected token in statement", current_.span, ErrorKind::Syntax));
+    return err<Statement>(Error("unexpected token in statement", current_.span, ErrorKind::Syntax));
 }
 
 Result<Statement> Parser::parse_assignment() {
@@ -169,8 +175,9 @@ Result<Statement> Parser::parse_assignment() {
     if (is_err(semi)) return err<Statement>(semi.error());
 
     Statement stmt;
-    stmt.value = Statement::Assignment{name_tok.value().lexeme, expr.value()};
-    return ok(stmt);
+    stmt.value = Statement::Assignment{std::string(name_tok.value().lexeme),
+                                       ast_.add(std::move(expr).value()), {}};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_var_declaration() {
@@ -182,7 +189,7 @@ Result<Statement> Parser::parse_var_declaration() {
     // Parse variable name
     auto name_tok = expect(TokenKind::Identifier, "expected variable name after type");
     if (is_err(name_tok)) return err<Statement>(name_tok.error());
-    std::string name = name_tok.value().lexeme;
+    std::string name(name_tok.value().lexeme);
 
     // Parse initializer: (expr) or () or () = expr
     auto lparen = expect(TokenKind::LParen, "expected '(' after variable name");
@@ -211,9 +218,12 @@ Result<Statement> Parser::parse_var_declaration() {
     auto semi = expect(TokenKind::Semicolon, "expected ';' after variable declaration");
     if (is_err(semi)) return err<Statement>(semi.error());
 
+    std::optional<ExprId> initializer_id;
+    if (initializer.has_value()) initializer_id = ast_.add(std::move(initializer).value());
+
     Statement stmt;
-    stmt.value = Statement::VarDecl{name, type, initializer};
-    return ok(stmt);
+    stmt.value = Statement::VarDecl{name, std::move(type), initializer_id, {}, false};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_if_statement() {
@@ -229,18 +239,18 @@ Result<Statement> Parser::parse_if_statement() {
     auto lbrace = expect(TokenKind::LBrace, "expected '{' after if condition");
     if (is_err(lbrace)) return err<Statement>(lbrace.error());
 
-    std::vector<StmtPtr> body;
+    std::vector<StmtId> body;
     while (!check(TokenKind::RBrace) && !check(TokenKind::EndOfFile)) {
         auto stmt = parse_statement();
         if (is_err(stmt)) return err<Statement>(stmt.error());
-        body.push_back(std::make_unique<Statement>(std::move(stmt).value()));
+        body.push_back(ast_.add(std::move(stmt).value()));
     }
 
     auto rbrace = expect(TokenKind::RBrace, "expected '}' after if body");
     if (is_err(rbrace)) return err<Statement>(rbrace.error());
 
     // elif clauses
-    std::vector<std::pair<Expr, std::vector<StmtPtr>>> elif_clauses;
+    std::vector<std::pair<ExprId, Block>> elif_clauses;
     while (match(TokenKind::KwElif)) {
         auto elif_lparen = expect(TokenKind::LParen, "expected '(' after 'elif'");
         if (is_err(elif_lparen)) return err<Statement>(elif_lparen.error());
@@ -254,21 +264,21 @@ Result<Statement> Parser::parse_if_statement() {
         auto elif_lbrace = expect(TokenKind::LBrace, "expected '{' after elif condition");
         if (is_err(elif_lbrace)) return err<Statement>(elif_lbrace.error());
 
-        std::vector<StmtPtr> elif_body;
+        std::vector<StmtId> elif_body;
         while (!check(TokenKind::RBrace) && !check(TokenKind::EndOfFile)) {
             auto stmt = parse_statement();
             if (is_err(stmt)) return err<Statement>(stmt.error());
-            elif_body.push_back(std::make_unique<Statement>(std::move(stmt).value()));
+            elif_body.push_back(ast_.add(std::move(stmt).value()));
         }
 
         auto elif_rbrace = expect(TokenKind::RBrace, "expected '}' after elif body");
         if (is_err(elif_rbrace)) return err<Statement>(elif_rbrace.error());
 
-        elif_clauses.emplace_back(elif_cond.value(), std::move(elif_body));
+        elif_clauses.emplace_back(ast_.add(std::move(elif_cond).value()), std::move(elif_body));
     }
 
     // else clause
-    std::vector<StmtPtr> else_body;
+    std::vector<StmtId> else_body;
     if (match(TokenKind::KwElse)) {
         auto else_lbrace = expect(TokenKind::LBrace, "expected '{' after 'else'");
         if (is_err(else_lbrace)) return err<Statement>(else_lbrace.error());
@@ -276,7 +286,7 @@ Result<Statement> Parser::parse_if_statement() {
         while (!check(TokenKind::RBrace) && !check(TokenKind::EndOfFile)) {
             auto stmt = parse_statement();
             if (is_err(stmt)) return err<Statement>(stmt.error());
-            else_body.push_back(std::make_unique<Statement>(std::move(stmt).value()));
+            else_body.push_back(ast_.add(std::move(stmt).value()));
         }
 
         auto else_rbrace = expect(TokenKind::RBrace, "expected '}' after else body");
@@ -288,8 +298,9 @@ Result<Statement> Parser::parse_if_statement() {
 
     Statement stmt;
     stmt.value =
-        Statement::If{cond.value(), std::move(body), std::move(elif_clauses), std::move(else_body)};
-    return ok(stmt);
+        Statement::If{ast_.add(std::move(cond).value()), std::move(body), std::move(elif_clauses),
+                      std::move(else_body)};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_while_statement() {
@@ -305,11 +316,11 @@ Result<Statement> Parser::parse_while_statement() {
     auto lbrace = expect(TokenKind::LBrace, "expected '{' after while condition");
     if (is_err(lbrace)) return err<Statement>(lbrace.error());
 
-    std::vector<StmtPtr> body;
+    std::vector<StmtId> body;
     while (!check(TokenKind::RBrace) && !check(TokenKind::EndOfFile)) {
         auto stmt = parse_statement();
         if (is_err(stmt)) return err<Statement>(stmt.error());
-        body.push_back(std::make_unique<Statement>(std::move(stmt).value()));
+        body.push_back(ast_.add(std::move(stmt).value()));
     }
 
     auto rbrace = expect(TokenKind::RBrace, "expected '}' after while body");
@@ -319,14 +330,14 @@ Result<Statement> Parser::parse_while_statement() {
     if (is_err(semi)) return err<Statement>(semi.error());
 
     Statement stmt;
-    stmt.value = Statement::While{cond.value(), std::move(body)};
-    return ok(stmt);
+    stmt.value = Statement::While{ast_.add(std::move(cond).value()), std::move(body)};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_function_def() {
     auto name_tok = expect(TokenKind::Identifier, "expected function name");
     if (is_err(name_tok)) return err<Statement>(name_tok.error());
-    std::string func_name = name_tok.value().lexeme;
+    std::string func_name(name_tok.value().lexeme);
 
     // Parse return type if present (BEFORE parameters as per docs: "function name returns type(params)")
     std::optional<AstType> return_type;
@@ -349,7 +360,8 @@ Result<Statement> Parser::parse_function_def() {
             auto param_name = expect(TokenKind::Identifier, "expected parameter name");
             if (is_err(param_name)) return err<Statement>(param_name.error());
 
-            params.emplace_back(param_name.value().lexeme, std::move(param_type).value());
+            params.emplace_back(std::string(param_name.value().lexeme),
+                                std::move(param_type).value());
         } while (match(TokenKind::Comma));
     }
 
@@ -359,11 +371,11 @@ Result<Statement> Parser::parse_function_def() {
     auto lbrace = expect(TokenKind::LBrace, "expected '{' after function signature");
     if (is_err(lbrace)) return err<Statement>(lbrace.error());
 
-    std::vector<StmtPtr> body;
+    std::vector<StmtId> body;
     while (!check(TokenKind::RBrace) && !check(TokenKind::EndOfFile)) {
         auto stmt = parse_statement();
         if (is_err(stmt)) return err<Statement>(stmt.error());
-        body.push_back(std::make_unique<Statement>(std::move(stmt).value()));
+        body.push_back(ast_.add(std::move(stmt).value()));
     }
 
     auto rbrace = expect(TokenKind::RBrace, "expected '}' after function body");
@@ -373,8 +385,9 @@ Result<Statement> Parser::parse_function_def() {
     if (is_err(semi)) return err<Statement>(semi.error());
 
     Statement stmt;
-    stmt.value = Statement::FunctionDef{func_name, params, std::move(body), return_type};
-    return ok(stmt);
+    stmt.value = Statement::FunctionDef{func_name, params, std::move(body), return_type, {}, 0, 0,
+                                        false};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_return_statement() {
@@ -385,8 +398,8 @@ Result<Statement> Parser::parse_return_statement() {
     if (is_err(semi)) return err<Statement>(semi.error());
 
     Statement stmt;
-    stmt.value = Statement::Return{expr.value()};
-    return ok(stmt);
+    stmt.value = Statement::Return{ast_.add(std::move(expr).value())};
+    return ok(std::move(stmt));
 }
 
 Result<Statement> Parser::parse_expression_statement() {
@@ -397,8 +410,8 @@ Result<Statement> Parser::parse_expression_statement() {
     if (is_err(semi)) return err<Statement>(semi.error());
 
     Statement stmt;
-    stmt.value = Statement::ExpressionStmt{expr.value()};
-    return ok(stmt);
+    stmt.value = Statement::ExpressionStmt{ast_.add(std::move(expr).value())};
+    return ok(std::move(stmt));
 }
 
 // Type parsing
@@ -406,7 +419,7 @@ Result<AstType> Parser::parse_type() {
     auto type_tok = expect(TokenKind::Identifier, "expected type name");
     if (is_err(type_tok)) return err<AstType>(type_tok.error());
 
-    std::string type_name = type_tok.value().lexeme;
+    std::string_view type_name = type_tok.value().lexeme;
     AstType type;
 
     if (type_name == "int") {
@@ -433,11 +446,11 @@ Result<AstType> Parser::parse_type() {
 
         type.value = AstType::List{std::make_unique<AstType>(elem_type.value())};
     } else {
-        return err<AstType>(std::make_shared<Error>("unknown type: " + type_name,
+        return err<AstType>(Error("unknown type: " + std::string(type_name),
                                                     type_tok.value().span, ErrorKind::Type));
     }
 
-    return ok(type);
+    return ok(std::move(type));
 }
 
 // Expression parsing (precedence climbing)
@@ -461,10 +474,10 @@ Result<Expr> Parser::parse_ternary() {
 
         Expr result;
         result.span = Span{expr.value().span.p1, else_expr.value().span.p2};
-        result.value = Expr::Ternary{std::make_unique<Expr>(std::move(expr).value()),
-                                     std::make_unique<Expr>(std::move(then_expr).value()),
-                                     std::make_unique<Expr>(std::move(else_expr).value())};
-        return ok(result);
+        result.value = Expr::Ternary{ast_.add(std::move(expr).value()),
+                                     ast_.add(std::move(then_expr).value()),
+                                     ast_.add(std::move(else_expr).value())};
+        return ok(std::move(result));
     }
 
     return expr;
@@ -482,8 +495,8 @@ Result<Expr> Parser::parse_logical_or() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), Operator::Or,
-                                      std::make_unique<Expr>(std::move(right).value())};
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), Operator::Or,
+                                      ast_.add(std::move(right).value())};
         left = ok(result);
     }
 
@@ -502,8 +515,8 @@ Result<Expr> Parser::parse_logical_and() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), Operator::And,
-                                      std::make_unique<Expr>(std::move(right).value())};
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), Operator::And,
+                                      ast_.add(std::move(right).value())};
         left = ok(result);
     }
 
@@ -539,8 +552,8 @@ Result<Expr> Parser::parse_comparison() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), op,
-                                      std::make_unique<Expr>(std::move(right).value())};
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), op,
+                                      ast_.add(std::move(right).value())};
         left = ok(result);
     }
 
@@ -570,8 +583,8 @@ Result<Expr> Parser::parse_addition() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), op,
-                                      std::make_unique<Expr>(std::move(right).value())};
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), op,
+                                      ast_.add(std::move(right).value())};
         left = ok(result);
     }
 
@@ -599,8 +612,8 @@ Result<Expr> Parser::parse_multiplication() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), op,
-                                      std::make_unique<Expr>(std::move(right).value())};
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), op,
+                                      ast_.add(std::move(right).value())};
         left = ok(result);
     }
 
@@ -619,9 +632,9 @@ Result<Expr> Parser::parse_exponentiation() {
         Span right_span = right.value().span;
         Expr result;
         result.span = Span{left_span.p1, right_span.p2};
-        result.value = Expr::BinaryOp{std::make_unique<Expr>(std::move(left).value()), Operator::Pow,
-                                      std::make_unique<Expr>(std::move(right).value())};
-        return ok(result);
+        result.value = Expr::BinaryOp{ast_.add(std::move(left).value()), Operator::Pow,
+                                      ast_.add(std::move(right).value())};
+        return ok(std::move(result));
     }
 
     return left;
@@ -636,8 +649,8 @@ Result<Expr> Parser::parse_unary() {
 
         Expr result;
         result.span = Span{start, expr.value().span.p2};
-        result.value = Expr::UnaryOp{Operator::Not, std::make_unique<Expr>(std::move(expr).value())};
-        return ok(result);
+        result.value = Expr::UnaryOp{Operator::Not, ast_.add(std::move(expr).value())};
+        return ok(std::move(result));
     }
 
     if (check(TokenKind::Minus)) {
@@ -648,8 +661,8 @@ Result<Expr> Parser::parse_unary() {
 
         Expr result;
         result.span = Span{start, expr.value().span.p2};
-        result.value = Expr::UnaryOp{Operator::Neg, std::make_unique<Expr>(std::move(expr).value())};
-        return ok(result);
+        result.value = Expr::UnaryOp{Operator::Neg, ast_.add(std::move(expr).value())};
+        return ok(std::move(result));
     }
 
     return parse_postfix();
@@ -664,18 +677,18 @@ Result<Expr> Parser::parse_postfix() {
         auto member_tok = expect(TokenKind::Identifier, "expected member name after '.'");
         if (is_err(member_tok)) return err<Expr>(member_tok.error());
 
-        std::string member_name = member_tok.value().lexeme;
+        std::string member_name(member_tok.value().lexeme);
 
         // Check if this is a method call: .method(args)
         if (check(TokenKind::LParen)) {
             advance();  // consume '('
             
-            std::vector<ExprPtr> args;
+            std::vector<ExprId> args;
             if (!check(TokenKind::RParen)) {
                 do {
                     auto arg = parse_expression();
                     if (is_err(arg)) return arg;
-                    args.push_back(std::make_unique<Expr>(arg.value()));
+                    args.push_back(ast_.add(std::move(arg).value()));
                 } while (match(TokenKind::Comma));
             }
 
@@ -683,19 +696,22 @@ Result<Expr> Parser::parse_postfix() {
             if (is_err(rparen)) return err<Expr>(rparen.error());
 
             // Create a special function call with the object as first arg (receiver)
-            args.insert(args.begin(), std::make_unique<Expr>(std::move(expr).value()));
+            args.insert(args.begin(), ast_.add(std::move(expr).value()));
             
             Expr result;
-            result.span = Span{args[0]->span.p1, rparen.value().span.p2};
+            result.span = Span{ast_.expr(args[0]).span.p1, rparen.value().span.p2};
             // Use special naming for method calls: __method_memberName
-            result.value = Expr::FunctionCall{"__method_" + member_name, std::move(args)};
+            auto method = MethodDispatcher::findMethod(member_name);
+            CallTarget target{CallTarget::Kind::Method, static_cast<std::uint32_t>(method)};
+            result.value =
+                Expr::FunctionCall{"__method_" + member_name, std::move(args), target, false};
             expr = ok(std::move(result));
         } else {
             // Regular member access
             Expr result;
             result.span = Span{expr.value().span.p1, member_tok.value().span.p2};
             result.value = Expr::MemberAccess{
-                std::make_unique<Expr>(std::move(expr).value()),
+                ast_.add(std::move(expr).value()),
                 member_name
             };
             expr = ok(std::move(result));
@@ -710,21 +726,21 @@ Result<Expr> Parser::parse_primary() {
     if (check(TokenKind::Int)) {
         Token tok = advance();
         RuntimeValue val;
-        val.value = RuntimeValue::Int{std::stoll(tok.lexeme)};
+        val.value = RuntimeValue::Int{std::stoll(std::string(tok.lexeme))};
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     if (check(TokenKind::Float)) {
         Token tok = advance();
         RuntimeValue val;
-        val.value = RuntimeValue::Float{std::stod(tok.lexeme)};
+        val.value = RuntimeValue::Float{std::stod(std::string(tok.lexeme))};
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     if (check(TokenKind::Bool)) {
@@ -734,59 +750,59 @@ Result<Expr> Parser::parse_primary() {
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     if (check(TokenKind::String)) {
         Token tok = advance();
         // Remove surrounding quotes
-        std::string str_val = tok.lexeme;
+        std::string_view str_val = tok.lexeme;
         if (str_val.size() >= 2 && (str_val.front() == '"' || str_val.front() == '\'')) {
             str_val = str_val.substr(1, str_val.size() - 2);
         }
         RuntimeValue val;
-        val.value = RuntimeValue::String{str_val};
+        val.value = RuntimeValue::String{std::string(str_val)};
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     if (check(TokenKind::FString)) {
         Token tok = advance();
         // Remove surrounding quotes from f-string
-        std::string str_val = tok.lexeme;
+        std::string_view str_val = tok.lexeme;
         if (str_val.size() >= 2 && (str_val.front() == '"' || str_val.front() == '\'')) {
             str_val = str_val.substr(1, str_val.size() - 2);
         }
         RuntimeValue val;
-        val.value = RuntimeValue::String{str_val};
+        val.value = RuntimeValue::String{std::string(str_val)};
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     if (check(TokenKind::Regex)) {
         Token tok = advance();
         // Parse regex: /pattern/flags
-        std::string lex = tok.lexeme;
+        std::string_view lex = tok.lexeme;
         size_t last_slash = lex.rfind('/');
-        std::string pattern = lex.substr(1, last_slash - 1);
-        std::string flags = (last_slash + 1 < lex.size()) ? lex.substr(last_slash + 1) : "";
+        std::string pattern(lex.substr(1, last_slash - 1));
+        std::string flags(last_slash + 1 < lex.size() ? lex.substr(last_slash + 1) : "");
 
         RuntimeValue val;
         val.value = RuntimeValue::Regex{RegexType{pattern, flags}};
         Expr expr;
         expr.value = Expr::Literal{val};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     // Identifier or function call or type cast
     if (check(TokenKind::Identifier)) {
         Token tok = advance();
-        std::string name = tok.lexeme;
+        std::string name(tok.lexeme);
 
         // Check for type cast or function call
         if (check(TokenKind::LParen)) {
@@ -839,17 +855,17 @@ Result<Expr> Parser::parse_primary() {
 
                 Expr expr;
                 expr.span = Span{start, rparen.value().span.p2};
-                expr.value = Expr::TypeCast{cast_type, std::make_unique<Expr>(std::move(cast_expr).value())};
-                return ok(expr);
+                expr.value = Expr::TypeCast{cast_type, ast_.add(std::move(cast_expr).value())};
+                return ok(std::move(expr));
             }
 
             // Regular function call
-            std::vector<ExprPtr> args;
+            std::vector<ExprId> args;
             if (!check(TokenKind::RParen)) {
                 do {
                     auto arg = parse_expression();
                     if (is_err(arg)) return arg;
-                    args.push_back(std::make_unique<Expr>(arg.value()));
+                    args.push_back(ast_.add(std::move(arg).value()));
                 } while (match(TokenKind::Comma));
             }
 
@@ -858,15 +874,23 @@ Result<Expr> Parser::parse_primary() {
 
             Expr expr;
             expr.span = Span{tok.span.p1, rparen.value().span.p2};
-            expr.value = Expr::FunctionCall{name, std::move(args)};
-            return ok(expr);
+            // User functions are numbered later by the resolver
+            CallTarget target;
+            if (name == "exit") {
+                target.kind = CallTarget::Kind::Exit;
+            } else if (auto builtin = builtin_functions::find_builtin(name)) {
+                target.kind = CallTarget::Kind::Builtin;
+                target.id = static_cast<std::uint32_t>(*builtin);
+            }
+            expr.value = Expr::FunctionCall{name, std::move(args), target, false};
+            return ok(std::move(expr));
         }
 
         // Just a variable
         Expr expr;
-        expr.value = Expr::Variable{name};
+        expr.value = Expr::Variable{name, {}};
         expr.span = tok.span;
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
     // Parenthesized expression
@@ -885,12 +909,12 @@ Result<Expr> Parser::parse_primary() {
         Pos start = current_.span.p1;
         advance();  // consume '{'
 
-        std::vector<ExprPtr> elements;
+        std::vector<ExprId> elements;
         if (!check(TokenKind::RBrace)) {
             do {
                 auto elem = parse_expression();
                 if (is_err(elem)) return elem;
-                elements.push_back(std::make_unique<Expr>(std::move(elem).value()));
+                elements.push_back(ast_.add(std::move(elem).value()));
             } while (match(TokenKind::Comma));
         }
 
@@ -900,10 +924,10 @@ Result<Expr> Parser::parse_primary() {
         Expr expr;
         expr.span = Span{start, rbrace.value().span.p2};
         expr.value = Expr::ListLiteral{std::move(elements)};
-        return ok(expr);
+        return ok(std::move(expr));
     }
 
-    return err<Expr>(std::make_shared<Error>("unexpected token in expression", current_.span,
+    return err<Expr>(Error("unexpected token in expression", current_.span,
                                              ErrorKind::Syntax));
 }
 
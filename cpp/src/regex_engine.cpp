@@ -0,0 +1,862 @@
+// regex_engine.cpp
+// Implements regex_engine.h
+
+#include "regex_engine.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstdint>
+#include <optional>
+#include <regex>
+#include <utility>
+
+#include "errors.hpp"
+
+namespace regex_engine {
+
+namespace {
+
+constexpr std::size_t UNBOUNDED = static_cast<std::size_t>(-1);
+// Counted repetition is expanded into copies of its operand; anything larger falls back to
+// std::regex rather than building a huge program
+constexpr std::size_t MAX_REPEAT = 1000;
+constexpr std::size_t MAX_PROGRAM_SIZE = 20000;
+
+using ByteSet = std::bitset<256>;
+
+enum class AssertKind : std::uint8_t { LineStart, LineEnd, WordBoundary, NotWordBoundary };
+
+bool is_word_byte(unsigned char c) {
+    return std::isalnum(c) || c == '_';
+}
+
+ByteSet range_set(unsigned char lo, unsigned char hi) {
+    ByteSet set;
+    for (unsigned c = lo; c <= hi; ++c) set.set(c);
+    return set;
+}
+
+// Set for \d \D \w \W \s \S
+ByteSet class_escape_set(char c) {
+    ByteSet set;
+    switch (std::tolower(static_cast<unsigned char>(c))) {
+        case 'd':
+            set = range_set('0', '9');
+            break;
+        case 'w':
+            for (unsigned b = 0; b < 256; ++b) set[b] = is_word_byte(static_cast<unsigned char>(b));
+            break;
+        case 's':
+            for (unsigned char b : {' ', '\t', '\n', '\v', '\f', '\r'}) set.set(b);
+            break;
+    }
+    if (std::isupper(static_cast<unsigned char>(c))) set.flip();
+    return set;
+}
+
+bool is_class_escape(char c) {
+    switch (c) {
+        case 'd': case 'D': case 'w': case 'W': case 's': case 'S':
+            return true;
+        default:
+            return false;
+    }
+}
+
+void fold_case(ByteSet& set) {
+    for (unsigned c = 'a'; c <= 'z'; ++c) {
+        unsigned upper = c - 'a' + 'A';
+        if (set[c] || set[upper]) {
+            set.set(c);
+            set.set(upper);
+        }
+    }
+}
+
+struct Node {
+    enum class Kind : std::uint8_t { Empty, Byte, Any, Set, Concat, Alt, Repeat, Group, Assert };
+
+    Kind kind = Kind::Empty;
+    unsigned char byte = 0;
+    /// Set: index into PatternParser::sets
+    std::size_t set = 0;
+    AssertKind assertion = AssertKind::LineStart;
+    /// Repeat: bounds, `max` may be UNBOUNDED
+    std::size_t min = 0;
+    std::size_t max = 0;
+    bool greedy = true;
+    /// Group: capture index, 0 for (?:...)
+    std::size_t group = 0;
+    std::vector<Node> children;
+};
+
+// Whether `n` can match without consuming input
+bool nullable(const Node& n) {
+    switch (n.kind) {
+        case Node::Kind::Byte:
+        case Node::Kind::Any:
+        case Node::Kind::Set:
+            return false;
+        case Node::Kind::Concat:
+            return std::all_of(n.children.begin(), n.children.end(), nullable);
+        case Node::Kind::Alt:
+            return std::any_of(n.children.begin(), n.children.end(), nullable);
+        case Node::Kind::Repeat:
+            return n.min == 0 || nullable(n.children.front());
+        case Node::Kind::Group:
+            return nullable(n.children.front());
+        default:
+            return true;
+    }
+}
+
+// Parses the supported subset; `parse()` gives up (std::nullopt) on anything else, including
+// malformed patterns, so that std::regex decides what they mean or reports the error
+class PatternParser {
+   public:
+    PatternParser(std::string_view src, bool icase) : src_(src), icase_(icase) {}
+
+    std::optional<Node> parse() {
+        Node root = parse_alt();
+        if (!ok_ || pos_ != src_.size()) return std::nullopt;
+        return root;
+    }
+
+    std::size_t group_count() const noexcept {
+        return groups_;
+    }
+
+    std::vector<ByteSet> sets;
+
+   private:
+    Node fail() {
+        ok_ = false;
+        return Node{};
+    }
+
+    bool at(char c) const {
+        return pos_ < src_.size() && src_[pos_] == c;
+    }
+
+    Node set_node(ByteSet set) {
+        if (icase_) fold_case(set);
+        Node n;
+        n.kind = Node::Kind::Set;
+        n.set = sets.size();
+        sets.push_back(set);
+        return n;
+    }
+
+    Node byte_node(unsigned char c) {
+        if (icase_ && std::isalpha(c)) {
+            ByteSet set;
+            set.set(c);
+            return set_node(set);
+        }
+        Node n;
+        n.kind = Node::Kind::Byte;
+        n.byte = c;
+        return n;
+    }
+
+    Node assert_node(AssertKind kind) {
+        Node n;
+        n.kind = Node::Kind::Assert;
+        n.assertion = kind;
+        return n;
+    }
+
+    Node parse_alt() {
+        Node first = parse_concat();
+        if (!at('|')) return first;
+        Node alt;
+        alt.kind = Node::Kind::Alt;
+        alt.children.push_back(std::move(first));
+        while (ok_ && at('|')) {
+            ++pos_;
+            alt.children.push_back(parse_concat());
+        }
+
+        // a|b|[0-9] is the same as [ab0-9] but runs as one instruction instead of a split chain
+        auto is_single_byte = [](const Node& n) {
+            return n.kind == Node::Kind::Byte || n.kind == Node::Kind::Set;
+        };
+        bool single_bytes = std::all_of(alt.children.begin(), alt.children.end(), is_single_byte);
+        if (!single_bytes) return alt;
+        ByteSet merged;
+        for (const auto& n : alt.children) {
+            if (n.kind == Node::Kind::Byte) merged.set(n.byte);
+            else merged |= sets[n.set];
+        }
+        return set_node(merged);
+    }
+
+    Node parse_concat() {
+        Node concat;
+        concat.kind = Node::Kind::Concat;
+        while (ok_ && pos_ < src_.size() && !at('|') && !at(')')) {
+            concat.children.push_back(parse_repeat());
+        }
+        if (concat.children.size() == 1) return std::move(concat.children.front());
+        return concat;
+    }
+
+    // Reads a decimal bound of a {n,m} quantifier
+    std::optional<std::size_t> parse_bound() {
+        std::size_t start = pos_;
+        std::size_t value = 0;
+        while (pos_ < src_.size() && std::isdigit(static_cast<unsigned char>(src_[pos_]))) {
+            value = value * 10 + static_cast<std::size_t>(src_[pos_] - '0');
+            if (value > MAX_REPEAT) return std::nullopt;
+            ++pos_;
+        }
+        if (pos_ == start) return std::nullopt;
+        return value;
+    }
+
+    Node parse_repeat() {
+        Node atom = parse_atom();
+        if (!ok_ || pos_ >= src_.size()) return atom;
+
+        std::size_t min = 0;
+        std::size_t max = 0;
+        switch (src_[pos_]) {
+            case '*':
+                min = 0, max = UNBOUNDED;
+                break;
+            case '+':
+                min = 1, max = UNBOUNDED;
+                break;
+            case '?':
+                min = 0, max = 1;
+                break;
+            case '{': {
+                ++pos_;
+                auto lo = parse_bound();
+                if (!lo) return fail();
+                min = max = *lo;
+                if (at(',')) {
+                    ++pos_;
+                    max = UNBOUNDED;
+                    if (!at('}')) {
+                        auto hi = parse_bound();
+                        if (!hi || *hi < min) return fail();
+                        max = *hi;
+                    }
+                }
+                if (!at('}')) return fail();
+                break;
+            }
+            default:
+                return atom;
+        }
+        ++pos_;
+        // ECMAScript rejects empty loop iterations and std::regex has its own take on that, so
+        // quantified operands that can match empty are left to std::regex
+        if (nullable(atom)) return fail();
+
+        Node repeat;
+        repeat.kind = Node::Kind::Repeat;
+        repeat.min = min;
+        repeat.max = max;
+        if (at('?')) {
+            repeat.greedy = false;
+            ++pos_;
+        }
+        if (at('*') || at('+') || at('?') || at('{')) return fail();
+        repeat.children.push_back(std::move(atom));
+        return repeat;
+    }
+
+    Node parse_atom() {
+        char c = src_[pos_++];
+        switch (c) {
+            case '(': {
+                std::size_t group = 0;
+                if (at('?')) {
+                    if (pos_ + 1 >= src_.size() || src_[pos_ + 1] != ':') return fail();
+                    pos_ += 2;
+                } else {
+                    group = ++groups_;
+                }
+                Node body = parse_alt();
+                if (!ok_ || !at(')')) return fail();
+                ++pos_;
+                Node n;
+                n.kind = Node::Kind::Group;
+                n.group = group;
+                n.children.push_back(std::move(body));
+                return n;
+            }
+            case '.': {
+                Node n;
+                n.kind = Node::Kind::Any;
+                return n;
+            }
+            case '^':
+                return assert_node(AssertKind::LineStart);
+            case '$':
+                return assert_node(AssertKind::LineEnd);
+            case '[':
+                return parse_class();
+            case '\\': {
+                if (pos_ >= src_.size()) return fail();
+                char e = src_[pos_];
+                if (e == 'b' || e == 'B') {
+                    ++pos_;
+                    return assert_node(e == 'b' ? AssertKind::WordBoundary
+                                                : AssertKind::NotWordBoundary);
+                }
+                if (is_class_escape(e)) {
+                    ++pos_;
+                    return set_node(class_escape_set(e));
+                }
+                auto b = parse_byte_escape();
+                if (!b) return fail();
+                return byte_node(*b);
+            }
+            case '*': case '+': case '?': case '{': case '}': case ']':
+                return fail();
+            default:
+                return byte_node(static_cast<unsigned char>(c));
+        }
+    }
+
+    // Reads a hex number of `digits` digits
+    std::optional<unsigned> parse_hex(std::size_t digits) {
+        unsigned value = 0;
+        for (std::size_t i = 0; i < digits; ++i, ++pos_) {
+            if (pos_ >= src_.size()) return std::nullopt;
+            unsigned char h = static_cast<unsigned char>(src_[pos_]);
+            if (!std::isxdigit(h)) return std::nullopt;
+            int digit = std::isdigit(h) ? h - '0' : std::tolower(h) - 'a' + 10;
+            value = value * 16 + static_cast<unsigned>(digit);
+        }
+        return value;
+    }
+
+    // Escape that stands for a single byte; `pos_` is just after the backslash
+    std::optional<unsigned char> parse_byte_escape() {
+        if (pos_ >= src_.size()) return std::nullopt;
+        char e = src_[pos_++];
+        switch (e) {
+            case 'n': return '\n';
+            case 'r': return '\r';
+            case 't': return '\t';
+            case 'f': return '\f';
+            case 'v': return '\v';
+            case '0':
+                if (pos_ < src_.size() && std::isdigit(static_cast<unsigned char>(src_[pos_])))
+                    return std::nullopt;
+                return '\0';
+            case 'x': {
+                auto v = parse_hex(2);
+                if (!v) return std::nullopt;
+                return static_cast<unsigned char>(*v);
+            }
+            case 'u': {
+                auto v = parse_hex(4);
+                if (!v || *v > 0x7F) return std::nullopt;
+                return static_cast<unsigned char>(*v);
+            }
+            default:
+                // Backreferences, \c and the like are left to std::regex
+                if (std::isalnum(static_cast<unsigned char>(e))) return std::nullopt;
+                return static_cast<unsigned char>(e);
+        }
+    }
+
+    // One class member that stands for a single byte
+    std::optional<unsigned char> parse_class_byte() {
+        if (pos_ >= src_.size()) return std::nullopt;
+        char c = src_[pos_];
+        if (c == '[') return std::nullopt;
+        if (c != '\\') {
+            ++pos_;
+            return static_cast<unsigned char>(c);
+        }
+        ++pos_;
+        if (pos_ < src_.size() && (src_[pos_] == 'b' || src_[pos_] == 'B')) return std::nullopt;
+        return parse_byte_escape();
+    }
+
+    // `pos_` is just after the '['
+    Node parse_class() {
+        bool negate = at('^');
+        if (negate) ++pos_;
+        // `[]` and `[^]` mean different things across regex dialects
+        if (at(']')) return fail();
+
+        ByteSet set;
+        while (true) {
+            if (pos_ >= src_.size()) return fail();
+            if (at(']')) {
+                ++pos_;
+                break;
+            }
+            if (at('\\') && pos_ + 1 < src_.size() && is_class_escape(src_[pos_ + 1])) {
+                set |= class_escape_set(src_[pos_ + 1]);
+                pos_ += 2;
+                if (at('-') && pos_ + 1 < src_.size() && src_[pos_ + 1] != ']') return fail();
+                continue;
+            }
+            auto lo = parse_class_byte();
+            if (!lo) return fail();
+            if (at('-') && pos_ + 1 < src_.size() && src_[pos_ + 1] != ']') {
+                ++pos_;
+                if (at('\\') && pos_ + 1 < src_.size() && is_class_escape(src_[pos_ + 1]))
+                    return fail();
+                auto hi = parse_class_byte();
+                if (!hi || *hi < *lo) return fail();
+                set |= range_set(*lo, *hi);
+            } else {
+                set.set(*lo);
+            }
+        }
+        if (icase_) fold_case(set);
+        if (negate) set.flip();
+        Node n;
+        n.kind = Node::Kind::Set;
+        n.set = sets.size();
+        sets.push_back(set);
+        return n;
+    }
+
+    std::string_view src_;
+    bool icase_;
+    std::size_t pos_ = 0;
+    std::size_t groups_ = 0;
+    bool ok_ = true;
+};
+
+enum class Op : std::uint8_t { Byte, Any, Set, Split, Jmp, Save, Assert, Match };
+
+struct Inst {
+    Op op;
+    unsigned char byte = 0;
+    /// Set: set index, Split/Jmp: preferred target, Save: capture slot, Assert: AssertKind
+    std::uint32_t x = 0;
+    /// Split: other target
+    std::uint32_t y = 0;
+};
+
+// Sparse set of pcs in insertion (= priority) order, with each thread's capture slots
+struct ThreadList {
+    // Empties the list and sizes it for `n` pcs; the buffers are only reallocated to grow
+    void reset(std::size_t n, std::size_t ncap) {
+        dense.resize(n);
+        sparse.resize(n);
+        caps.resize(n * ncap);
+        size = 0;
+    }
+
+    bool contains(std::uint32_t pc) const {
+        std::uint32_t i = sparse[pc];
+        return i < size && dense[i] == pc;
+    }
+    void insert(std::uint32_t pc) {
+        sparse[pc] = static_cast<std::uint32_t>(size);
+        dense[size++] = pc;
+    }
+    void clear() {
+        size = 0;
+    }
+
+    std::vector<std::uint32_t> dense;
+    std::vector<std::uint32_t> sparse;
+    std::vector<std::size_t> caps;
+    std::size_t size = 0;
+};
+
+// Either a pc still to explore or a capture slot to restore once its branch is done
+struct StackEntry {
+    std::uint32_t pc;
+    bool restore;
+    std::uint32_t slot;
+    std::size_t old;
+};
+
+}  // namespace
+
+struct Scratch::Buffers {
+    ThreadList clist;
+    ThreadList nlist;
+    std::vector<std::size_t> work;
+    std::vector<std::size_t> best;
+    std::vector<StackEntry> stack;
+};
+
+Scratch::Scratch() = default;
+Scratch::~Scratch() = default;
+
+namespace {
+
+// Pike VM: runs all threads in lockstep over the input. Threads are kept in priority order and
+// a pc is only added once per position, so the first thread to reach Match is the match a
+// backtracking engine would have found first
+class PikeProgram final : public Program {
+   public:
+    PikeProgram(std::vector<ByteSet> sets, std::size_t groups)
+        : sets_(std::move(sets)), groups_(groups), ncap_(2 * (groups + 1)) {}
+
+    // Compiles `root` wrapped in Save 0 / Save 1 / Match; false if the program gets too large
+    bool build(const Node& root) {
+        emit({Op::Save, 0, 0, 0});
+        if (!emit_node(root)) return false;
+        emit({Op::Save, 0, 1, 0});
+        emit({Op::Match});
+        compute_first_bytes();
+        return true;
+    }
+
+    bool search(std::string_view text, std::size_t from, SearchMode mode, Captures& caps,
+                Scratch& scratch) const override {
+        if (!scratch.buffers) scratch.buffers = std::make_unique<Scratch::Buffers>();
+        auto& [clist, nlist, work, best, stack] = *scratch.buffers;
+        clist.reset(insts_.size(), ncap_);
+        nlist.reset(insts_.size(), ncap_);
+        work.assign(ncap_, Group::NPOS);
+        best.clear();
+        stack.clear();
+
+        for (std::size_t pos = from;; ++pos) {
+            if (best.empty() && (!mode.anchored || pos == from)) {
+                if (clist.size == 0 && !mode.anchored && use_first_bytes_) {
+                    while (pos < text.size() &&
+                           !first_bytes_[static_cast<unsigned char>(text[pos])]) {
+                        ++pos;
+                    }
+                    if (pos == text.size()) break;
+                }
+                std::fill(work.begin(), work.end(), Group::NPOS);
+                add_thread(clist, 0, text, pos, work, stack);
+            }
+            if (clist.size == 0) break;
+
+            nlist.clear();
+            for (std::size_t i = 0; i < clist.size; ++i) {
+                std::uint32_t pc = clist.dense[i];
+                const std::size_t* tcaps = &clist.caps[pc * ncap_];
+                const Inst& inst = insts_[pc];
+                if (inst.op == Op::Match) {
+                    if (mode.not_empty && tcaps[0] == tcaps[1]) continue;
+                    best.assign(tcaps, tcaps + ncap_);
+                    // Lower-priority threads can't win anymore
+                    break;
+                }
+                if (pos < text.size() && consumes(inst, static_cast<unsigned char>(text[pos]))) {
+                    std::copy(tcaps, tcaps + ncap_, work.begin());
+                    add_thread(nlist, pc + 1, text, pos + 1, work, stack);
+                }
+            }
+            std::swap(clist, nlist);
+            if (pos >= text.size()) break;
+        }
+
+        if (best.empty()) return false;
+        caps.assign(groups_ + 1, Group{});
+        for (std::size_t g = 0; g <= groups_; ++g) {
+            if (best[2 * g] != Group::NPOS && best[2 * g + 1] != Group::NPOS)
+                caps[g] = Group{best[2 * g], best[2 * g + 1]};
+        }
+        return true;
+    }
+
+    std::size_t group_count() const noexcept override {
+        return groups_;
+    }
+
+    bool is_linear() const noexcept override {
+        return true;
+    }
+
+   private:
+    std::uint32_t pc() const {
+        return static_cast<std::uint32_t>(insts_.size());
+    }
+
+    void emit(Inst inst) {
+        insts_.push_back(inst);
+    }
+
+    bool emit_node(const Node& n) {
+        if (insts_.size() > MAX_PROGRAM_SIZE) return false;
+        switch (n.kind) {
+            case Node::Kind::Empty:
+                return true;
+            case Node::Kind::Byte:
+                emit({Op::Byte, n.byte});
+                return true;
+            case Node::Kind::Any:
+                emit({Op::Any});
+                return true;
+            case Node::Kind::Set:
+                emit({Op::Set, 0, static_cast<std::uint32_t>(n.set)});
+                return true;
+            case Node::Kind::Assert:
+                emit({Op::Assert, 0, static_cast<std::uint32_t>(n.assertion)});
+                return true;
+            case Node::Kind::Concat:
+                for (const auto& child : n.children) {
+                    if (!emit_node(child)) return false;
+                }
+                return true;
+            case Node::Kind::Group:
+                if (n.group) emit({Op::Save, 0, static_cast<std::uint32_t>(2 * n.group)});
+                if (!emit_node(n.children.front())) return false;
+                if (n.group) emit({Op::Save, 0, static_cast<std::uint32_t>(2 * n.group + 1)});
+                return true;
+            case Node::Kind::Alt: {
+                // split L1, next; L1: a; jmp end; next: split L2, ... ; last alternative
+                std::vector<std::uint32_t> to_end;
+                for (std::size_t i = 0; i < n.children.size(); ++i) {
+                    bool last = i + 1 == n.children.size();
+                    std::uint32_t split = pc();
+                    if (!last) emit({Op::Split, 0, split + 1});
+                    if (!emit_node(n.children[i])) return false;
+                    if (!last) {
+                        to_end.push_back(pc());
+                        emit({Op::Jmp});
+                        insts_[split].y = pc();
+                    }
+                }
+                for (std::uint32_t j : to_end) insts_[j].x = pc();
+                return true;
+            }
+            case Node::Kind::Repeat:
+                return emit_repeat(n);
+        }
+        return false;
+    }
+
+    // Split preferring the loop body for greedy repeats and the exit for lazy ones; the exit
+    // target is patched in once known
+    void emit_split(bool greedy, std::uint32_t body) {
+        emit({Op::Split, 0, greedy ? body : 0, greedy ? 0 : body});
+    }
+    void patch_exit(std::uint32_t split, bool greedy) {
+        (greedy ? insts_[split].y : insts_[split].x) = pc();
+    }
+
+    bool emit_repeat(const Node& n) {
+        const Node& body = n.children.front();
+        for (std::size_t i = 0; i < n.min; ++i) {
+            if (!emit_node(body)) return false;
+        }
+        if (n.max == UNBOUNDED) {
+            // loop: split body, exit; body; jmp loop
+            std::uint32_t loop = pc();
+            emit_split(n.greedy, loop + 1);
+            if (!emit_node(body)) return false;
+            emit({Op::Jmp, 0, loop});
+            patch_exit(loop, n.greedy);
+            return true;
+        }
+        // x{0,k}: k nested optional copies, each split exiting to the end
+        std::vector<std::uint32_t> splits;
+        for (std::size_t i = n.min; i < n.max; ++i) {
+            splits.push_back(pc());
+            emit_split(n.greedy, pc() + 1);
+            if (!emit_node(body)) return false;
+        }
+        for (std::uint32_t s : splits) patch_exit(s, n.greedy);
+        return true;
+    }
+
+    // Bytes a match can start with, so the search can skip ahead while no thread is alive. Not
+    // used if the pattern can match the empty string
+    void compute_first_bytes() {
+        std::vector<bool> seen(insts_.size(), false);
+        std::vector<std::uint32_t> todo{0};
+        use_first_bytes_ = true;
+        while (!todo.empty()) {
+            std::uint32_t p = todo.back();
+            todo.pop_back();
+            if (seen[p]) continue;
+            seen[p] = true;
+            const Inst& inst = insts_[p];
+            switch (inst.op) {
+                case Op::Byte:
+                    first_bytes_.set(inst.byte);
+                    break;
+                case Op::Any:
+                case Op::Set:
+                    for (unsigned b = 0; b < 256; ++b) {
+                        if (consumes(inst, static_cast<unsigned char>(b))) first_bytes_.set(b);
+                    }
+                    break;
+                case Op::Split:
+                    todo.push_back(inst.x);
+                    todo.push_back(inst.y);
+                    break;
+                case Op::Jmp:
+                    todo.push_back(inst.x);
+                    break;
+                case Op::Save:
+                case Op::Assert:
+                    todo.push_back(p + 1);
+                    break;
+                case Op::Match:
+                    use_first_bytes_ = false;
+                    return;
+            }
+        }
+    }
+
+    bool consumes(const Inst& inst, unsigned char c) const {
+        switch (inst.op) {
+            case Op::Byte:
+                return c == inst.byte;
+            case Op::Any:
+                return c != '\n' && c != '\r';
+            case Op::Set:
+                return sets_[inst.x][c];
+            default:
+                return false;
+        }
+    }
+
+    static bool assertion_holds(AssertKind kind, std::string_view text, std::size_t pos) {
+        switch (kind) {
+            case AssertKind::LineStart:
+                return pos == 0;
+            case AssertKind::LineEnd:
+                return pos == text.size();
+            case AssertKind::WordBoundary:
+            case AssertKind::NotWordBoundary: {
+                bool before = pos > 0 && is_word_byte(static_cast<unsigned char>(text[pos - 1]));
+                bool after =
+                    pos < text.size() && is_word_byte(static_cast<unsigned char>(text[pos]));
+                return (before != after) == (kind == AssertKind::WordBoundary);
+            }
+        }
+        return false;
+    }
+
+    // Follows Split/Jmp/Save/Assert from `start` and adds every thread that ends on a consuming
+    // instruction or Match, with the capture slots in effect on the way there
+    void add_thread(ThreadList& list, std::uint32_t start, std::string_view text, std::size_t pos,
+                    std::vector<std::size_t>& caps, std::vector<StackEntry>& stack) const {
+        stack.push_back({start, false, 0, 0});
+        while (!stack.empty()) {
+            StackEntry e = stack.back();
+            stack.pop_back();
+            if (e.restore) {
+                caps[e.slot] = e.old;
+                continue;
+            }
+            std::uint32_t p = e.pc;
+            while (!list.contains(p)) {
+                list.insert(p);
+                const Inst& inst = insts_[p];
+                if (inst.op == Op::Jmp) {
+                    p = inst.x;
+                } else if (inst.op == Op::Split) {
+                    stack.push_back({inst.y, false, 0, 0});
+                    p = inst.x;
+                } else if (inst.op == Op::Save) {
+                    stack.push_back({0, true, inst.x, caps[inst.x]});
+                    caps[inst.x] = pos;
+                    ++p;
+                } else if (inst.op == Op::Assert) {
+                    if (!assertion_holds(static_cast<AssertKind>(inst.x), text, pos)) break;
+                    ++p;
+                } else {
+                    std::copy(caps.begin(), caps.end(), list.caps.begin() + p * ncap_);
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<Inst> insts_;
+    std::vector<ByteSet> sets_;
+    std::size_t groups_;
+    std::size_t ncap_;
+    ByteSet first_bytes_;
+    bool use_first_bytes_ = false;
+};
+
+class StdProgram final : public Program {
+   public:
+    StdProgram(const std::string& literal, const std::string& flags)
+        : re_(literal, to_flag_type(flags)) {}
+
+    bool search(std::string_view text, std::size_t from, SearchMode mode, Captures& caps,
+                Scratch&) const override {
+        auto flags = std::regex_constants::match_default;
+        if (from > 0) flags |= std::regex_constants::match_prev_avail;
+        if (mode.anchored) flags |= std::regex_constants::match_continuous;
+        if (mode.not_empty) flags |= std::regex_constants::match_not_null;
+
+        const char* base = text.data();
+        std::cmatch m;
+        if (!std::regex_search(base + from, base + text.size(), m, re_, flags)) return false;
+        caps.assign(m.size(), Group{});
+        for (std::size_t g = 0; g < m.size(); ++g) {
+            if (m[g].matched) {
+                caps[g] = Group{static_cast<std::size_t>(m[g].first - base),
+                                static_cast<std::size_t>(m[g].second - base)};
+            }
+        }
+        return true;
+    }
+
+    std::size_t group_count() const noexcept override {
+        return re_.mark_count();
+    }
+
+    bool is_linear() const noexcept override {
+        return false;
+    }
+
+   private:
+    static std::regex::flag_type to_flag_type(const std::string& flags) {
+        std::regex::flag_type type = std::regex::ECMAScript;
+        for (char c : flags) {
+            if (c == 'i') type |= std::regex::icase;
+            // Add more flag support as needed
+        }
+        return type;
+    }
+
+    std::regex re_;
+};
+
+}  // namespace
+
+Result<std::shared_ptr<const Program>> compile(const std::string& literal,
+                                               const std::string& flags) {
+    PatternParser parser(literal, flags.find('i') != std::string::npos);
+    if (auto root = parser.parse()) {
+        auto program = std::make_shared<PikeProgram>(std::move(parser.sets), parser.group_count());
+        if (program->build(*root)) return ok(std::shared_ptr<const Program>(std::move(program)));
+    }
+
+    try {
+        return ok(std::shared_ptr<const Program>(std::make_shared<StdProgram>(literal, flags)));
+    } catch (const std::regex_error& e) {
+        return err<std::shared_ptr<const Program>>(
+            Error(std::string("regex error: ") + e.what(), ErrorKind::Runtime));
+    }
+}
+
+void for_each_match(const Program& program, std::string_view text,
+                    const std::function<void(const Captures&)>& fn) {
+    Captures caps;
+    Scratch scratch;
+    if (!program.search(text, 0, SearchMode{}, caps, scratch)) return;
+    while (true) {
+        fn(caps);
+        std::size_t next = caps[0].end;
+        if (caps[0].start == caps[0].end) {
+            if (next == text.size()) return;
+            if (program.search(text, next, SearchMode{true, true}, caps, scratch)) continue;
+            ++next;
+        }
+        if (!program.search(text, next, SearchMode{}, caps, scratch)) return;
+    }
+}
+
+}  // namespace regex_engine
@@ -0,0 +1,209 @@
+// resolver.cpp
+// Implements resolver.h
+
+#include "resolver.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace resolver {
+
+/// @return Name written by an assignment or declaration statement, or nullptr for other statements
+static const std::string* assigned_name(const Statement& s) {
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) return &a->name;
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) return &vd->name;
+    return nullptr;
+}
+
+std::uint32_t Resolver::resolve(Ast& ast) {
+    Scope global{nullptr, true, {}, {}};
+    Frame frame;
+    ast_ = &ast;
+    global_ = &global;
+    current_ = &global;
+    frame_ = &frame;
+
+    for (auto id : ast.root) declare_local(id);
+    for (auto id : ast.root) resolve_statement(id);
+
+    ast_ = nullptr;
+    global_ = nullptr;
+    current_ = nullptr;
+    frame_ = nullptr;
+    return frame.num_slots;
+}
+
+void Resolver::resolve_block(Block& block) {
+    Scope scope{current_, false, {}, {}};
+    current_ = &scope;
+    block.first_slot = frame_->next_slot;
+
+    for (auto id : block.statements) declare_local(id);
+    block.num_slots = frame_->next_slot - block.first_slot;
+    for (auto id : block.statements) resolve_statement(id);
+
+    // Later sibling blocks reuse this block's slots
+    frame_->next_slot = block.first_slot;
+    current_ = scope.parent;
+}
+
+void Resolver::resolve_function(Statement::FunctionDef& fd) {
+    // Function bodies only see the global scope, whatever block they are defined in. Globals are
+    // never considered bound inside them since the function may run before they are assigned
+    Scope* outer = current_;
+    Frame* outer_frame = frame_;
+    Scope scope{global_, true, {}, {}};
+    Frame frame;
+    current_ = &scope;
+    frame_ = &frame;
+
+    // Parameters always live in the callee's frame, even when a global has the same name
+    fd.param_slots.clear();
+    for (const auto& param : fd.params) {
+        declare(param.first);
+        fd.param_slots.push_back(scope.slots.at(param.first));
+        scope.bound.insert(param.first);
+    }
+
+    for (auto id : fd.body.statements) declare_local(id);
+    fd.body.first_slot = 0;
+    fd.body.num_slots = frame.next_slot;
+    for (auto id : fd.body.statements) resolve_statement(id);
+
+    fd.frame_slots = frame.num_slots;
+    current_ = outer;
+    frame_ = outer_frame;
+}
+
+std::uint32_t Resolver::function_id(const std::string& name) {
+    auto next = static_cast<std::uint32_t>(functions_.size());
+    return functions_.try_emplace(name, next).first->second;
+}
+
+void Resolver::declare_local(StmtId id) {
+    const Statement& s = ast_->stmt(id);
+    const std::string* name = assigned_name(s);
+    if (!name || is_bound(*name)) return;
+    // Inside a function, assigning a global's name updates the global (see `lookup`)
+    if (std::holds_alternative<Statement::Assignment>(s.value) && lookup(*name).depth > 0) return;
+    declare(*name);
+}
+
+void Resolver::resolve_statement(StmtId id) {
+    Statement& s = ast_->stmt(id);
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
+        resolve_expr(a->expr);
+        a->target = lookup(a->name);
+        // A global assigned by a function stays shadowable by the function's declarations
+        if (a->target.depth == 0) current_->bound.insert(a->name);
+        return;
+    }
+
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
+        if (vd->initializer.has_value()) resolve_expr(*vd->initializer);
+        // A declaration never reaches past its frame, so locals shadow globals of the same name
+        vd->target = lookup(vd->name, true);
+        current_->bound.insert(vd->name);
+        return;
+    }
+
+    if (auto i = std::get_if<Statement::If>(&s.value)) {
+        resolve_expr(i->condition);
+        resolve_block(i->body);
+        for (auto& [cond, body] : i->elif) {
+            resolve_expr(cond);
+            resolve_block(body);
+        }
+        resolve_block(i->else_body);
+        return;
+    }
+
+    if (auto w = std::get_if<Statement::While>(&s.value)) {
+        resolve_expr(w->condition);
+        resolve_block(w->body);
+        return;
+    }
+
+    if (auto r = std::get_if<Statement::Return>(&s.value)) {
+        resolve_expr(r->value);
+        return;
+    }
+
+    if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
+        fd->function_id = function_id(fd->name);
+        resolve_function(*fd);
+        return;
+    }
+
+    if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
+        resolve_expr(es->expr);
+        return;
+    }
+}
+
+void Resolver::resolve_expr(ExprId id) {
+    using E = Expr;
+    Expr& expr = ast_->expr(id);
+
+    if (auto v = std::get_if<E::Variable>(&expr.value)) {
+        v->binding = lookup(v->name);
+    } else if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        resolve_expr(u->next);
+    } else if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        resolve_expr(b->left);
+        resolve_expr(b->right);
+    } else if (auto fc = std::get_if<E::FunctionCall>(&expr.value)) {
+        if (fc->target.kind == CallTarget::Kind::Function) fc->target.id = function_id(fc->name);
+        for (auto arg : fc->args) resolve_expr(arg);
+    } else if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        resolve_expr(t->condition);
+        resolve_expr(t->then_expr);
+        resolve_expr(t->else_expr);
+    } else if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        for (auto elem : ll->elements) resolve_expr(elem);
+    } else if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        resolve_expr(tc->expr);
+    } else if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        resolve_expr(ma->object);
+    }
+}
+
+bool Resolver::is_bound(const std::string& name) const {
+    for (const Scope* s = current_; s; s = s->parent) {
+        if (s->bound.contains(name)) return true;
+        // Globals may be unassigned when a function runs
+        if (s->is_frame) break;
+    }
+    return false;
+}
+
+SlotRef Resolver::lookup(const std::string& name, bool frame_only) const {
+    // Within a frame, a slot is assigned at runtime exactly when the resolver has seen it bound:
+    // block slots are cleared on entry and frames start empty. So the innermost bound slot is the
+    // one holding the variable, and the innermost slot is where an unbound one gets created
+    SlotRef innermost;
+    std::uint32_t depth = 0;
+    for (const Scope* s = current_; s; s = s->parent) {
+        auto it = s->slots.find(name);
+        if (it != s->slots.end()) {
+            // Whether a global is assigned when a function runs isn't known here, so a function
+            // uses the global unless it has bound the name itself
+            if (depth > 0) return SlotRef{depth, it->second};
+            if (s->bound.contains(name)) return SlotRef{0, it->second};
+            if (innermost.slot == SlotRef::UNBOUND) innermost = SlotRef{0, it->second};
+        }
+        if (s->is_frame) {
+            if (frame_only) break;
+            ++depth;
+        }
+    }
+    return innermost;
+}
+
+void Resolver::declare(const std::string& name) {
+    if (current_->slots.contains(name)) return;
+    current_->slots.emplace(name, frame_->next_slot++);
+    frame_->num_slots = std::max(frame_->num_slots, frame_->next_slot);
+}
+
+}  // namespace resolver
@@ -6,54 +6,84 @@
 #include <cmath>
 #include <cstdlib>
 #include <regex>
+#include <utility>
 
+#include "compiler.h"
 #include "utils/builtin_functions.h"
 #include "utils/method_dispatcher.hpp"
 #include "utils/runtime_utils.h"
 #include "utils/types_utils.hpp"
+#include "vm.h"
 
-std::optional<RuntimeValue> Environment::get(const std::string& name) {
-    if (variables.contains(name)) return variables[name];
-    if (parent) return parent->get(name);
-    return std::nullopt;
+Environment& Environment::ancestor(std::uint32_t depth) {
+    Environment* env = this;
+    for (; depth > 0; --depth) env = env->parent.get();
+    return *env;
 }
 
-void Environment::set(const std::string& name, const RuntimeValue& value) {
-    // Check if variable exists in current scope
-    if (variables.contains(name)) {
-        variables[name] = value;
-        return;
-    }
-    // Check if variable exists in parent scope
-    if (parent) {
-        auto parent_var = parent->get(name);
-        if (parent_var.has_value()) {
-            // Variable exists in parent scope, update it there
-            parent->set(name, value);
-            return;
-        }
+RuntimeValue* Environment::get(SlotRef ref) {
+    if (ref.slot == SlotRef::UNBOUND) return nullptr;
+    auto& slot = ancestor(ref.depth).slots[ref.slot];
+    return slot.has_value() ? &slot.value() : nullptr;
+}
+
+void Environment::set(SlotRef ref, RuntimeValue value) {
+    ancestor(ref.depth).slots[ref.slot] = std::move(value);
+}
+
+void Environment::clear_slots(std::uint32_t first, std::uint32_t count) {
+    for (std::uint32_t i = 0; i < count; ++i) slots[first + i].reset();
+}
+
+env_ptr Interpreter::acquire_frame(std::size_t num_slots) {
+    if (this->free_frames.empty()) {
+        this->stats.scope_allocations++;
+        return std::make_shared<Environment>(num_slots, this->global_env);
     }
-    // Variable doesn't exist anywhere - this is an error for Assignment
-    // But VarDecl will call this after creating the variable, so we create it
-    variables[name] = value;
+    env_ptr env = std::move(this->free_frames.back());
+    this->free_frames.pop_back();
+    env->slots.assign(num_slots, std::nullopt);
+    env->parent = this->global_env;
+    return env;
 }
 
-Result<RuntimeValue> Interpreter::run(const std::vector<Statement>& stmts) {
-    auto r = this->eval_statements(stmts, *this->global_env);
+void Interpreter::release_frame(env_ptr env) {
+    // Frames are never captured, but don't recycle one that is still referenced. A pooled frame
+    // holds no values, so it can't keep a list or string shared after the call
+    if (env.use_count() != 1) return;
+    env->slots.clear();
+    this->free_frames.push_back(std::move(env));
+}
+
+Result<RuntimeValue> Interpreter::run(const Ast& ast, std::uint32_t global_slots) {
+    this->ast = &ast;
+    this->global_env = std::make_shared<Environment>(global_slots);
+    this->stats.scope_allocations++;
+    this->free_frames.clear();
+    this->functions.clear();
+
+    if (this->engine == Engine::Bytecode) {
+        compiler::Compiler compiler;
+        auto program = compiler.compile(ast);
+        vm::VM machine(*this);
+        return machine.run(program);
+    }
+
+    auto r = this->eval_statements(ast.root, *this->global_env);
     if (is_err(r)) return err<RuntimeValue>(r.error());
-    ExecFlow exec = r.value();
+    ExecFlow exec = std::move(r).value();
     return std::visit(overloaded{[](ExecFlow::None) -> Result<RuntimeValue> {
                                      return ok(RuntimeValue{RuntimeValue::Null{}});
                                  },
                                  [](ExecFlow::Return& r) -> Result<RuntimeValue> {
-                                     return ok(RuntimeValue{r.value});
+                                     return ok(std::move(r.value));
                                  },
                                  [](ExecFlow::Break) -> Result<RuntimeValue> {
-                                     return err<RuntimeValue>(std::make_shared<Error>(
+                                     return err<RuntimeValue>(Error(
                                          "invalid 'break' statement", ErrorKind::Syntax));
                                  },
                                  [](ExecFlow::Continue) -> Result<RuntimeValue> {
-                                     return err<RuntimeValue>(std::make_shared<Error>(
+                                     return err<RuntimeValue>(Error(
                                          "invalid 'continue' statement", ErrorKind::Syntax));
                                  },
                                  [](ExecFlow::Exit) -> Result<RuntimeValue> {
@@ -63,350 +93,190 @@ Result<RuntimeValue> Interpreter::run(const std::vector<Statement>& stmts) {
                       exec.value);
 }
 
-Result<ExecFlow> Interpreter::eval_statements(const std::vector<Statement>& stmts,
-                                              Environment& env) {
-    for (const auto& s : stmts) {
-        // Assignment
-        if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
-            auto r = this->eval_expr(a->expr, env.shared_from_this());
-            if (is_err(r)) return err<ExecFlow>(r.error());
-            env.set(a->name, r.value());
-            continue;
-        }
-
-        // Variable Declaration
-        if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
-            RuntimeValue value;
-            if (vd->initializer.has_value()) {
-                // Has initializer expression
-                auto r = this->eval_expr(vd->initializer.value(), env.shared_from_this());
-                if (is_err(r)) return err<ExecFlow>(r.error());
-                value = r.value();
-                // Type check
-                if (!matches_type(value, vd->type)) {
-                    return err<ExecFlow>(std::make_shared<Error>(
-                        "initializer type does not match declared type", ErrorKind::Type));
-                }
-            } else {
-                // Empty initializer - default to null
-                value.value = RuntimeValue::Null{};
-            }
-            env.set(vd->name, value);
-            continue;
-        }
-
-        // If
-        if (auto i = std::get_if<Statement::If>(&s.value)) {
-            auto cond_r = this->eval_expr(i->condition, env.shared_from_this());
-            if (is_err(cond_r)) return err<ExecFlow>(cond_r.error());
-            if (is_truthy(cond_r.value())) {
-                auto child = std::make_shared<Environment>(env.shared_from_this());
-                auto flow = this->eval_statements(i->body, *child);
-                if (is_err(flow)) return err<ExecFlow>(flow.error());
-                if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
-            } else {
-                bool matched = false;
-                for (auto& el : i->elif) {
-                    auto er = this->eval_expr(el.first, env.shared_from_this());
-                    if (is_err(er)) return err<ExecFlow>(er.error());
-                    if (is_truthy(er.value())) {
-                        matched = true;
-                        auto child = std::make_shared<Environment>(env.shared_from_this());
-                        auto flow = this->eval_statements(el.second, *child);
-                        if (is_err(flow)) return err<ExecFlow>(flow.error());
-                        if (!std::holds_alternative<ExecFlow::None>(flow.value().value))
-                            return flow;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    auto child = std::make_shared<Environment>(env.shared_from_this());
-                    auto flow = this->eval_statements(i->else_body, *child);
-                    if (is_err(flow)) return err<ExecFlow>(flow.error());
-                    if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
-                }
-            }
-            continue;
-        }
-
-        // While
-        if (auto w = std::get_if<Statement::While>(&s.value)) {
-            while (true) {
-                auto cr = this->eval_expr(w->condition, env.shared_from_this());
-                if (is_err(cr)) return err<ExecFlow>(cr.error());
-                if (!is_truthy(cr.value())) break;
-                auto child = std::make_shared<Environment>(env.shared_from_this());
-                auto flow = this->eval_statements(w->body, *child);
-                if (is_err(flow)) return err<ExecFlow>(flow.error());
-                if (std::holds_alternative<ExecFlow::Return>(flow.value().value)) return flow;
-                if (std::holds_alternative<ExecFlow::Break>(flow.value().value)) break;
-            }
-            continue;
-        }
-
-        // Return
-        if (auto r = std::get_if<Statement::Return>(&s.value)) {
-            ExecFlow f;
-            auto e = this->eval_expr(r->value, env.shared_from_this());
-            if (is_err(e)) return err<ExecFlow>(e.error());
-            f.value = ExecFlow::Return{e.value()};
-            return ok(f);
-        }
-
-        // Break
-        if (std::get_if<Statement::Break>(&s.value)) {
-            ExecFlow f;
-            f.value = ExecFlow::Break{};
-            return ok(f);
-        }
-
-        // Continue
-        if (std::get_if<Statement::Continue>(&s.value)) {
-            ExecFlow f;
-            f.value = ExecFlow::Continue{};
-            return ok(f);
-        }
-
-        // FunctionDef
-        if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
-            MethodRepr method;
-            method.args = fd->params;
-            method.returnType = fd->return_type.value_or(astCreateNull());
-            // Copy the function body statements
-            method.body.clear();
-            for (const auto& stmt_ptr : fd->body) {
-                method.body.push_back(*stmt_ptr);
-            }
-            this->functions[fd->name] = method;
-            continue;
-        }
-
-        // Expression statement
-        if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
-            auto r = this->eval_expr(es->expr, env.shared_from_this());
-            if (is_err(r)) return err<ExecFlow>(r.error());
-            // Discard the result
-            continue;
-        }
+Result<ExecFlow> Interpreter::eval_statements(const std::vector<StmtId>& stmts, Environment& env) {
+    for (auto id : stmts) {
+        auto flow = this->eval_statement(id, env);
+        if (is_err(flow) || !std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
     }
     ExecFlow f;
     f.value = ExecFlow::None{};
-    return ok(f);
+    return ok(std::move(f));
 }
 
-// Overload to avoid copying Statement objects from unique_ptrs
-Result<ExecFlow> Interpreter::eval_statements(const std::vector<StmtPtr>& stmts, Environment& env) {
-    for (const auto& stmt_ptr : stmts) {
-        const Statement& s = *stmt_ptr;
+Result<ExecFlow> Interpreter::eval_block(const Block& block, Environment& env) {
+    env.clear_slots(block.first_slot, block.num_slots);
+    return this->eval_statements(block.statements, env);
+}
 
-        // Assignment
-        if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
-            auto r = this->eval_expr(a->expr, env.shared_from_this());
-            if (is_err(r)) return err<ExecFlow>(r.error());
-            env.set(a->name, r.value());
-            continue;
-        }
+Result<ExecFlow> Interpreter::eval_statement(StmtId id, Environment& env) {
+    const Statement& s = this->ast->stmt(id);
+    // Assignment
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
+        auto r = this->eval_expr(a->expr, env);
+        if (is_err(r)) return err<ExecFlow>(r.error());
+        env.set(a->target, std::move(r).value());
+        return ok(ExecFlow{ExecFlow::None{}});
+    }
 
-        // Variable Declaration
-        if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
-            RuntimeValue value;
-            if (vd->initializer.has_value()) {
-                // Has initializer expression
-                auto r = this->eval_expr(vd->initializer.value(), env.shared_from_this());
-                if (is_err(r)) return err<ExecFlow>(r.error());
-                value = r.value();
-                // Type check
-                if (!matches_type(value, vd->type)) {
-                    return err<ExecFlow>(std::make_shared<Error>(
-                        "initializer type does not match declared type", ErrorKind::Type));
-                }
-            } else {
-                // Empty initializer - default to null
-                value.value = RuntimeValue::Null{};
+    // Variable Declaration
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
+        RuntimeValue value;
+        if (vd->initializer.has_value()) {
+            // Has initializer expression
+            auto r = this->eval_expr(*vd->initializer, env);
+            if (is_err(r)) return err<ExecFlow>(r.error());
+            value = std::move(r).value();
+            // Type check, unless the type checker proved it
+            if (!vd->initializer_proven && !matches_type(value, vd->type)) {
+                return err<ExecFlow>(Error(
+                    "initializer type does not match declared type", ErrorKind::Type));
             }
-            env.set(vd->name, value);
-            continue;
+        } else {
+            // Empty initializer - default to null
+            value.value = RuntimeValue::Null{};
         }
+        env.set(vd->target, std::move(value));
+        return ok(ExecFlow{ExecFlow::None{}});
+    }
 
-        // If
-        if (auto i = std::get_if<Statement::If>(&s.value)) {
-            auto cond_r = this->eval_expr(i->condition, env.shared_from_this());
-            if (is_err(cond_r)) return err<ExecFlow>(cond_r.error());
-            if (is_truthy(cond_r.value())) {
-                auto child = std::make_shared<Environment>(env.shared_from_this());
-                auto flow = this->eval_statements(i->body, *child);
-                if (is_err(flow)) return err<ExecFlow>(flow.error());
-                if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
-            } else {
-                bool matched = false;
-                for (auto& el : i->elif) {
-                    auto er = this->eval_expr(el.first, env.shared_from_this());
-                    if (is_err(er)) return err<ExecFlow>(er.error());
-                    if (is_truthy(er.value())) {
-                        matched = true;
-                        auto child = std::make_shared<Environment>(env.shared_from_this());
-                        auto flow = this->eval_statements(el.second, *child);
-                        if (is_err(flow)) return err<ExecFlow>(flow.error());
-                        if (!std::holds_alternative<ExecFlow::None>(flow.value().value))
-                            return flow;
-                        break;
-                    }
-                }
-                if (!matched) {
-                    auto child = std::make_shared<Environment>(env.shared_from_this());
-                    auto flow = this->eval_statements(i->else_body, *child);
+    // If
+    if (auto i = std::get_if<Statement::If>(&s.value)) {
+        auto cond_r = this->eval_expr(i->condition, env);
+        if (is_err(cond_r)) return err<ExecFlow>(cond_r.error());
+        if (is_truthy(cond_r.value())) {
+            auto flow = this->eval_block(i->body, env);
+            if (is_err(flow)) return err<ExecFlow>(flow.error());
+            if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
+        } else {
+            bool matched = false;
+            for (auto& el : i->elif) {
+                auto er = this->eval_expr(el.first, env);
+                if (is_err(er)) return err<ExecFlow>(er.error());
+                if (is_truthy(er.value())) {
+                    matched = true;
+                    auto flow = this->eval_block(el.second, env);
                     if (is_err(flow)) return err<ExecFlow>(flow.error());
-                    if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
+                    if (!std::holds_alternative<ExecFlow::None>(flow.value().value))
+                        return flow;
+                    break;
                 }
             }
-            continue;
-        }
-
-        // While
-        if (auto w = std::get_if<Statement::While>(&s.value)) {
-            while (true) {
-                auto cr = this->eval_expr(w->condition, env.shared_from_this());
-                if (is_err(cr)) return err<ExecFlow>(cr.error());
-                if (!is_truthy(cr.value())) break;
-                auto child = std::make_shared<Environment>(env.shared_from_this());
-                auto flow = this->eval_statements(w->body, *child);
+            if (!matched) {
+                auto flow = this->eval_block(i->else_body, env);
                 if (is_err(flow)) return err<ExecFlow>(flow.error());
-                if (std::holds_alternative<ExecFlow::Return>(flow.value().value)) return flow;
-                if (std::holds_alternative<ExecFlow::Break>(flow.value().value)) break;
+                if (!std::holds_alternative<ExecFlow::None>(flow.value().value)) return flow;
             }
-            continue;
         }
+        return ok(ExecFlow{ExecFlow::None{}});
+    }
 
-        // Return
-        if (auto r = std::get_if<Statement::Return>(&s.value)) {
-            ExecFlow f;
-            auto e = this->eval_expr(r->value, env.shared_from_this());
-            if (is_err(e)) return err<ExecFlow>(e.error());
-            f.value = ExecFlow::Return{e.value()};
-            return ok(f);
+    // While
+    if (auto w = std::get_if<Statement::While>(&s.value)) {
+        while (true) {
+            auto cr = this->eval_expr(w->condition, env);
+            if (is_err(cr)) return err<ExecFlow>(cr.error());
+            if (!is_truthy(cr.value())) break;
+            auto flow = this->eval_block(w->body, env);
+            if (is_err(flow)) return err<ExecFlow>(flow.error());
+            if (std::holds_alternative<ExecFlow::Return>(flow.value().value)) return flow;
+            if (std::holds_alternative<ExecFlow::Break>(flow.value().value)) break;
         }
+        return ok(ExecFlow{ExecFlow::None{}});
+    }
 
-        // Break
-        if (std::get_if<Statement::Break>(&s.value)) {
-            ExecFlow f;
-            f.value = ExecFlow::Break{};
-            return ok(f);
-        }
+    // Return
+    if (auto r = std::get_if<Statement::Return>(&s.value)) {
+        ExecFlow f;
+        auto e = this->eval_expr(r->value, env);
+        if (is_err(e)) return err<ExecFlow>(e.error());
+        f.value = ExecFlow::Return{std::move(e).value()};
+        return ok(std::move(f));
+    }
 
-        // Continue
-        if (std::get_if<Statement::Continue>(&s.value)) {
-            ExecFlow f;
-            f.value = ExecFlow::Continue{};
-            return ok(f);
-        }
+    // Break
+    if (std::get_if<Statement::Break>(&s.value)) {
+        ExecFlow f;
+        f.value = ExecFlow::Break{};
+        return ok(std::move(f));
+    }
 
-        // FunctionDef
-        if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
-            MethodRepr method;
-            method.args = fd->params;
-            method.returnType = fd->return_type.value_or(astCreateNull());
-            // Copy the function body statements
-            method.body.clear();
-            for (const auto& stmt_ptr : fd->body) {
-                method.body.push_back(*stmt_ptr);
-            }
-            this->functions[fd->name] = method;
-            continue;
-        }
+    // Continue
+    if (std::get_if<Statement::Continue>(&s.value)) {
+        ExecFlow f;
+        f.value = ExecFlow::Continue{};
+        return ok(std::move(f));
+    }
 
-        // Expression statement
-        if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
-            auto r = this->eval_expr(es->expr, env.shared_from_this());
-            if (is_err(r)) return err<ExecFlow>(r.error());
-            // Discard the result
-            continue;
-        }
+    // FunctionDef
+    if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
+        // The AST outlives the run, so the function just refers to its definition
+        if (fd->function_id >= this->functions.size())
+            this->functions.resize(fd->function_id + 1, nullptr);
+        this->functions[fd->function_id] = fd;
+        return ok(ExecFlow{ExecFlow::None{}});
     }
-    ExecFlow f;
-    f.value = ExecFlow::None{};
-    return ok(f);
+
+    // Expression statement
+    if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
+        auto r = this->eval_expr(es->expr, env);
+        if (is_err(r)) return err<ExecFlow>(r.error());
+        // Discard the result
+        return ok(ExecFlow{ExecFlow::None{}});
+    }
+    return ok(ExecFlow{ExecFlow::None{}});
 }
 
-Result<RuntimeValue> Interpreter::eval_expr(const Expr& expr, env_ptr env) {
+Result<RuntimeValue> Interpreter::eval_expr(ExprId id, Environment& env) {
     using E = Expr;
+    const Expr& expr = this->ast->expr(id);
 
     if (std::holds_alternative<E::Literal>(expr.value)) {
-        auto lit = std::get<E::Literal>(expr.value);
-        return ok(lit.value);
+        return ok(std::get<E::Literal>(expr.value).value);
     }
 
     if (std::holds_alternative<E::Variable>(expr.value)) {
-        auto v = std::get<E::Variable>(expr.value);
-        if (!env) {
-            return err<RuntimeValue>(std::make_shared<Error>(
-                "Variable '" + v.name + "' is undefined (no environment)", ErrorKind::Runtime));
-        }
-        auto ov = env->get(v.name);
-        if (ov.has_value()) return ok(ov.value());
+        const auto& v = std::get<E::Variable>(expr.value);
+        const RuntimeValue* value = env.get(v.binding);
+        if (value) return ok(*value);
         return err<RuntimeValue>(
-            std::make_shared<Error>("Variable '" + v.name + "' is undefined", ErrorKind::Runtime));
+            Error("Variable '" + v.name + "' is undefined", ErrorKind::Runtime));
     }
 
     if (std::holds_alternative<E::UnaryOp>(expr.value)) {
         const auto& u = std::get<E::UnaryOp>(expr.value);
-        auto r = this->eval_expr(*u.next, env);
+        auto r = this->eval_expr(u.next, env);
         if (is_err(r)) return err<RuntimeValue>(r.error());
-
-        if (u.op == Operator::Not) {
-            bool val = is_truthy(r.value());
-            RuntimeValue out;
-            out.value = RuntimeValue::Bool{!val};
-            return ok(out);
-        }
-        if (u.op == Operator::Neg) {
-            // numeric negation
-            if (std::holds_alternative<RuntimeValue::Int>(r.value().value)) {
-                auto v = std::get<RuntimeValue::Int>(r.value().value).value;
-                RuntimeValue out;
-                out.value = RuntimeValue::Int{-v};
-                return ok(out);
-            }
-            if (std::holds_alternative<RuntimeValue::Float>(r.value().value)) {
-                auto v = std::get<RuntimeValue::Float>(r.value().value).value;
-                RuntimeValue out;
-                out.value = RuntimeValue::Float{-v};
-                return ok(out);
-            }
-            return err<RuntimeValue>(
-                std::make_shared<Error>("unsupported operand type for unary -", ErrorKind::Type));
-        }
-        return err<RuntimeValue>(
-            std::make_shared<Error>("unsupported unary operator", ErrorKind::Runtime));
+        return runtime_utils::eval_unary_op(u.op, r.value());
     }
 
     if (std::holds_alternative<E::BinaryOp>(expr.value)) {
         const auto& b = std::get<E::BinaryOp>(expr.value);
-        auto lr = this->eval_expr(*b.left, env);
+        auto lr = this->eval_expr(b.left, env);
         if (is_err(lr)) return err<RuntimeValue>(lr.error());
-        RuntimeValue l = lr.value();
+        RuntimeValue l = std::move(lr).value();
 
         // Short-circuiting logical operators
         if (b.op == Operator::And && !is_truthy(l)) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{false};
-            return ok(out);
+            return ok(std::move(out));
         }
         if (b.op == Operator::Or && is_truthy(l)) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{true};
-            return ok(out);
+            return ok(std::move(out));
         }
 
         // Evaluate RHS (either for non-short-circuiting ops or when short-circuit didn't trigger)
-        auto rr = this->eval_expr(*b.right, env);
+        auto rr = this->eval_expr(b.right, env);
         if (is_err(rr)) return err<RuntimeValue>(rr.error());
-        RuntimeValue r = rr.value();
+        RuntimeValue r = std::move(rr).value();
 
         // Handle logical operators that need RHS evaluation
         if (b.op == Operator::And || b.op == Operator::Or) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{is_truthy(r)};
-            return ok(out);
+            return ok(std::move(out));
         }
 
         return runtime_utils::eval_binary_op(b.op, l, r);
@@ -415,76 +285,60 @@ Result<RuntimeValue> Interpreter::eval_expr(const Expr& expr, env_ptr env) {
     if (std::holds_alternative<E::FunctionCall>(expr.value)) {
         const auto& fc = std::get<E::FunctionCall>(expr.value);
         std::vector<RuntimeValue> eval_args;
-        for (auto& a : fc.args) {
-            auto ar = this->eval_expr(*a, env);
+        for (auto a : fc.args) {
+            auto ar = this->eval_expr(a, env);
             if (is_err(ar)) return err<RuntimeValue>(ar.error());
-            eval_args.push_back(ar.value());
+            eval_args.push_back(std::move(ar).value());
         }
 
-        if (fc.name == "exit") {
-            ExecFlow flow;
-            flow.value = ExecFlow::Exit{};
-            return err<RuntimeValue>(
-                std::make_shared<Error>("Program exit requested", ErrorKind::Exit));
+        switch (fc.target.kind) {
+            case CallTarget::Kind::Exit:
+                return err<RuntimeValue>(Error("Program exit requested", ErrorKind::Exit));
+            case CallTarget::Kind::Builtin:
+                return builtin_functions::call_builtin(
+                    static_cast<builtin_functions::BuiltinId>(fc.target.id), eval_args,
+                    this->logger, this->console, this->clipboard, this->alert, this);
+            case CallTarget::Kind::Method:
+                // Dispatch method calls to appropriate handlers
+                return MethodDispatcher::dispatchMethod(
+                    static_cast<MethodDispatcher::MethodId>(fc.target.id), fc.name, eval_args);
+            case CallTarget::Kind::Function:
+                break;
         }
 
-        // Check if it's a builtin function
-        static const std::array builtin_names = {"fstring",
-                                                 "setLog",
-                                                 "log",
-                                                 "print",
-                                                 "clipboard_isText",
-                                                 "clipboard_read",
-                                                 "clipboard_write",
-                                                 "showAlertOK",
-                                                 "showAlert",
-                                                 "showAlertYesNoCancel"};
-        if (std::find(builtin_names.begin(), builtin_names.end(), fc.name) != builtin_names.end()) {
-            return builtin_functions::call_builtin(fc.name, eval_args, this->logger, this->console,
-                                                   this->clipboard, this->alert, this);
-        }
-
-        // Dispatch method calls to appropriate handlers
-        if (fc.name.starts_with("__method_")) {
-            return MethodDispatcher::dispatchMethod(fc.name, eval_args);
-        }
-
-        auto it = this->functions.find(fc.name);
-        if (it != this->functions.end()) {
-            MethodRepr& m = it->second;
-            if (m.args.size() != eval_args.size())
-                return err<RuntimeValue>(
-                    std::make_shared<Error>("argument count mismatch", ErrorKind::Arity));
+        if (fc.target.id < this->functions.size() && this->functions[fc.target.id]) {
+            const Statement::FunctionDef& fd = *this->functions[fc.target.id];
+            if (fd.params.size() != eval_args.size())
+                return err<RuntimeValue>(Error("argument count mismatch", ErrorKind::Arity));
             // Create function environment with global_env as parent, not calling env
             // This prevents recursive calls from corrupting parent call's parameters
-            auto child = std::make_shared<Environment>(this->global_env);
+            auto child = this->acquire_frame(fd.frame_slots);
             // Bind arguments by position - vector preserves parameter order
-            std::size_t idx = 0;
-            for (auto& kv : m.args) {
-                const std::string& pname = kv.first;
-                const AstType& pty = kv.second;
-                if (!matches_type(eval_args[idx], pty))
-                    return err<RuntimeValue>(
-                        std::make_shared<Error>("argument type mismatch", ErrorKind::Type));
-                child->set(pname, eval_args[idx]);
-                ++idx;
+            for (std::size_t idx = 0; idx < fd.params.size(); ++idx) {
+                const AstType& pty = fd.params[idx].second;
+                if (!fc.args_proven && !matches_type(eval_args[idx], pty))
+                    return err<RuntimeValue>(Error("argument type mismatch", ErrorKind::Type));
+                child->slots[fd.param_slots[idx]] = std::move(eval_args[idx]);
             }
-            auto flow = this->eval_statements(m.body, *child);
+            auto flow = this->eval_statements(fd.body.statements, *child);
             if (is_err(flow)) return err<RuntimeValue>(flow.error());
+            this->release_frame(std::move(child));
+            const bool returns_value =
+                fd.return_type && !std::holds_alternative<AstType::Null>(fd.return_type->value);
             if (std::holds_alternative<ExecFlow::Return>(flow.value().value)) {
-                auto ret = std::get<ExecFlow::Return>(flow.value().value).value;
-                if (!std::holds_alternative<AstType::Null>(m.returnType.value)) {
-                    if (!matches_type(ret, m.returnType)) {
-                        return err<RuntimeValue>(std::make_shared<Error>(
+                auto ret = std::move(std::get<ExecFlow::Return>(flow.value().value).value);
+                if (returns_value && !fd.returns_proven) {
+                    if (!matches_type(ret, *fd.return_type)) {
+                        return err<RuntimeValue>(Error(
                             "function returned value that does not match declared return type",
                             ErrorKind::Type));
                     }
                 }
-                return ok(ret);
+                return ok(std::move(ret));
             }
             if (std::holds_alternative<ExecFlow::None>(flow.value().value)) {
-                if (!std::holds_alternative<AstType::Null>(m.returnType.value)) {
-                    return err<RuntimeValue>(std::make_shared<Error>(
+                if (returns_value) {
+                    return err<RuntimeValue>(Error(
                         "function did not return a value but has declared return type",
                         ErrorKind::Type));
                 }
@@ -492,53 +346,51 @@ Result<RuntimeValue> Interpreter::eval_expr(const Expr& expr, env_ptr env) {
             }
             if (std::holds_alternative<ExecFlow::Break>(flow.value().value) ||
                 std::holds_alternative<ExecFlow::Continue>(flow.value().value)) {
-                return err<RuntimeValue>(std::make_shared<Error>(
+                return err<RuntimeValue>(Error(
                     "unexpected control flow in function body", ErrorKind::Runtime));
             }
         }
 
-        return err<RuntimeValue>(
-            std::make_shared<Error>("attempted to call a non-callable value", ErrorKind::Type));
+        return err<RuntimeValue>(Error("attempted to call a non-callable value", ErrorKind::Type));
     }
 
     if (std::holds_alternative<E::Ternary>(expr.value)) {
         auto& t = std::get<E::Ternary>(expr.value);
-        auto cr = this->eval_expr(*t.condition, env);
+        auto cr = this->eval_expr(t.condition, env);
         if (is_err(cr)) return err<RuntimeValue>(cr.error());
         if (is_truthy(cr.value()))
-            return this->eval_expr(*t.then_expr, env);
+            return this->eval_expr(t.then_expr, env);
         else
-            return this->eval_expr(*t.else_expr, env);
+            return this->eval_expr(t.else_expr, env);
     }
 
     if (std::holds_alternative<E::ListLiteral>(expr.value)) {
         auto& ll = std::get<E::ListLiteral>(expr.value);
         std::vector<RuntimeValue> values;
         values.reserve(ll.elements.size());
-        for (const auto& elem_ptr : ll.elements) {
-            auto r = this->eval_expr(*elem_ptr, env);
+        for (auto elem : ll.elements) {
+            auto r = this->eval_expr(elem, env);
             if (is_err(r)) return err<RuntimeValue>(r.error());
-            values.push_back(r.value());
+            values.push_back(std::move(r).value());
         }
         RuntimeValue result;
         result.value = RuntimeValue::List{std::move(values)};
-        return ok(result);
+        return ok(std::move(result));
     }
 
     if (std::holds_alternative<E::TypeCast>(expr.value)) {
         auto& tc = std::get<E::TypeCast>(expr.value);
-        auto val_result = this->eval_expr(*tc.expr, env);
+        auto val_result = this->eval_expr(tc.expr, env);
         if (is_err(val_result)) return err<RuntimeValue>(val_result.error());
         return runtime_utils::cast_value(val_result.value(), tc.target_type);
     }
 
     if (std::holds_alternative<E::MemberAccess>(expr.value)) {
         auto& ma = std::get<E::MemberAccess>(expr.value);
-        auto obj_result = this->eval_expr(*ma.object, env);
+        auto obj_result = this->eval_expr(ma.object, env);
         if (is_err(obj_result)) return err<RuntimeValue>(obj_result.error());
         return runtime_utils::access_member(obj_result.value(), ma.member);
     }
 
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported expression type", ErrorKind::Runtime));
+    return err<RuntimeValue>(Error("unsupported expression type", ErrorKind::Runtime));
 }
\ No newline at end of file
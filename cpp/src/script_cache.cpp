@@ -0,0 +1,710 @@
+// script_cache.cpp
+// Implements script_cache.h
+
+#include "script_cache.h"
+
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "utils/builtin_functions.h"
+#include "utils/method_dispatcher.hpp"
+#include "utils/variant_utils.hpp"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef COPYCLEANER_VERSION
+#define COPYCLEANER_VERSION "dev"
+#endif
+
+namespace script_cache {
+
+namespace {
+
+constexpr std::string_view MAGIC = "CCLC";
+/// bump whenever the layout below, the meaning of an AST field (including the numbering of
+/// `Operator`) or the optimizer's output changes. Builtin and method ids are covered by
+/// `dispatch_fingerprint` instead
+constexpr std::uint32_t FORMAT_VERSION = 2;
+/// deeper `list<...>` nesting is treated as corruption rather than recursed into
+constexpr int MAX_TYPE_DEPTH = 64;
+
+/// @brief FNV-1a; tells versions of one script apart (together with the size) and catches a
+/// damaged cache body
+std::uint64_t hash_bytes(std::string_view bytes) {
+    std::uint64_t h = 14695981039346656037ull;
+    for (unsigned char c : bytes) {
+        h ^= c;
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/// @brief Appends fields to a byte buffer: 32-bit values as LEB128, 64-bit ones little-endian
+class Writer {
+   public:
+    void u8(std::uint8_t v) {
+        out_.push_back(static_cast<char>(v));
+    }
+    /// LEB128: ids, lengths and positions are mostly small, so this keeps the file compact
+    void u32(std::uint32_t v) {
+        while (v >= 0x80) {
+            u8(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        u8(static_cast<std::uint8_t>(v));
+    }
+    void u64(std::uint64_t v) {
+        for (int i = 0; i < 8; ++i) u8(static_cast<std::uint8_t>(v >> (8 * i)));
+    }
+    void str(std::string_view s) {
+        u32(static_cast<std::uint32_t>(s.size()));
+        out_.append(s);
+    }
+    void ids(const std::vector<std::uint32_t>& ids) {
+        u32(static_cast<std::uint32_t>(ids.size()));
+        for (auto id : ids) u32(id);
+    }
+
+    const std::string& data() const noexcept {
+        return out_;
+    }
+
+   private:
+    std::string out_;
+};
+
+/// @brief Reads what `Writer` wrote. Running past the end or reading an out-of-range value sets
+/// `failed()` and yields zeros from then on, so callers only check once at the end
+class Reader {
+   public:
+    explicit Reader(std::string_view in) : in_(in) {}
+
+    std::uint8_t u8() {
+        if (failed_ || pos_ >= in_.size()) return fail();
+        return static_cast<std::uint8_t>(in_[pos_++]);
+    }
+    std::uint32_t u32() {
+        std::uint32_t v = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            std::uint8_t byte = u8();
+            v |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return v;
+        }
+        return fail();
+    }
+    std::uint64_t u64() {
+        std::uint64_t v = 0;
+        for (int i = 0; i < 8; ++i) v |= static_cast<std::uint64_t>(u8()) << (8 * i);
+        return v;
+    }
+    std::string str() {
+        std::uint32_t n = u32();
+        if (failed_ || n > in_.size() - pos_) return fail(), std::string();
+        std::string s(in_.substr(pos_, n));
+        pos_ += n;
+        return s;
+    }
+    /// @return A value below `limit`
+    std::uint32_t below(std::uint32_t limit) {
+        std::uint32_t v = u32();
+        return v < limit ? v : fail();
+    }
+    /// @return A list of values below `limit`
+    std::vector<std::uint32_t> ids(std::uint32_t limit) {
+        std::uint32_t n = u32();
+        // Each id takes at least a byte, so a count the input can't hold is corrupt
+        if (failed_ || n > in_.size() - pos_) return fail(), std::vector<std::uint32_t>();
+        std::vector<std::uint32_t> out(n);
+        for (auto& id : out) id = below(limit);
+        return out;
+    }
+
+    std::uint8_t fail() {
+        failed_ = true;
+        return 0;
+    }
+    bool failed() const noexcept {
+        return failed_;
+    }
+    bool at_end() const noexcept {
+        return pos_ == in_.size();
+    }
+
+   private:
+    std::string_view in_;
+    std::size_t pos_ = 0;
+    bool failed_ = false;
+};
+
+void write_span(Writer& out, const Span& span) {
+    out.u32(span.p1.line);
+    out.u32(span.p1.column);
+    out.u32(span.p2.line);
+    out.u32(span.p2.column);
+}
+
+Span read_span(Reader& in) {
+    Span span;
+    span.p1.line = in.u32();
+    span.p1.column = in.u32();
+    span.p2.line = in.u32();
+    span.p2.column = in.u32();
+    return span;
+}
+
+void write_type(Writer& out, const AstType& type) {
+    out.u8(static_cast<std::uint8_t>(type.value.index()));
+    if (auto list = std::get_if<AstType::List>(&type.value)) {
+        out.u8(list->element ? 1 : 0);
+        if (list->element) write_type(out, *list->element);
+    }
+}
+
+AstType read_type(Reader& in, int depth = 0) {
+    AstType type;
+    switch (in.u8()) {
+        case variant_index_v<AstType::Int, AstType::Variant>:
+            type.value = AstType::Int{};
+            break;
+        case variant_index_v<AstType::Float, AstType::Variant>:
+            type.value = AstType::Float{};
+            break;
+        case variant_index_v<AstType::Bool, AstType::Variant>:
+            type.value = AstType::Bool{};
+            break;
+        case variant_index_v<AstType::String, AstType::Variant>:
+            type.value = AstType::String{};
+            break;
+        case variant_index_v<AstType::Regex, AstType::Variant>:
+            type.value = AstType::Regex{};
+            break;
+        case variant_index_v<AstType::Match, AstType::Variant>:
+            type.value = AstType::Match{};
+            break;
+        case variant_index_v<AstType::Null, AstType::Variant>:
+            type.value = AstType::Null{};
+            break;
+        case variant_index_v<AstType::List, AstType::Variant>: {
+            AstType::List list;
+            if (in.u8() != 0) {
+                if (depth >= MAX_TYPE_DEPTH) {
+                    in.fail();
+                    break;
+                }
+                list.element = std::make_unique<AstType>(read_type(in, depth + 1));
+            }
+            type.value = std::move(list);
+            break;
+        }
+        default:
+            in.fail();
+            break;
+    }
+    return type;
+}
+
+/// @return false if the literal can't come out of the parser, and so isn't cached
+bool write_literal(Writer& out, const RuntimeValue& value) {
+    out.u8(static_cast<std::uint8_t>(value.value.index()));
+    return std::visit(
+        [&](const auto& v) -> bool {
+            using T = std::decay_t<decltype(v)>;
+
+            if constexpr (std::is_same_v<T, RuntimeValue::Int>) {
+                out.u64(static_cast<std::uint64_t>(v.value));
+            } else if constexpr (std::is_same_v<T, RuntimeValue::Float>) {
+                out.u64(std::bit_cast<std::uint64_t>(v.value));
+            } else if constexpr (std::is_same_v<T, RuntimeValue::Bool>) {
+                out.u8(v.value ? 1 : 0);
+            } else if constexpr (std::is_same_v<T, RuntimeValue::String>) {
+                out.str(*v.value);
+            } else if constexpr (std::is_same_v<T, RuntimeValue::Regex>) {
+                out.str(v.re->literal);
+                out.str(v.re->flags);
+            } else if constexpr (!std::is_same_v<T, RuntimeValue::Null>) {
+                return false;
+            }
+            return true;
+        },
+        value.value);
+}
+
+RuntimeValue read_literal(Reader& in) {
+    RuntimeValue value;
+    switch (in.u8()) {
+        case variant_index_v<RuntimeValue::Int, RuntimeValue::Variant>:
+            value.value = RuntimeValue::Int{static_cast<std::int64_t>(in.u64())};
+            break;
+        case variant_index_v<RuntimeValue::Float, RuntimeValue::Variant>:
+            value.value = RuntimeValue::Float{std::bit_cast<double>(in.u64())};
+            break;
+        case variant_index_v<RuntimeValue::Bool, RuntimeValue::Variant>:
+            value.value = RuntimeValue::Bool{in.u8() != 0};
+            break;
+        case variant_index_v<RuntimeValue::String, RuntimeValue::Variant>:
+            value.value = RuntimeValue::String{in.str()};
+            break;
+        case variant_index_v<RuntimeValue::Regex, RuntimeValue::Variant>: {
+            std::string literal = in.str();
+            value.value = RuntimeValue::Regex{RegexType{std::move(literal), in.str()}};
+            break;
+        }
+        case variant_index_v<RuntimeValue::Null, RuntimeValue::Variant>:
+            value.value = RuntimeValue::Null{};
+            break;
+        default:
+            in.fail();
+            break;
+    }
+    return value;
+}
+
+Operator read_operator(Reader& in) {
+    std::uint8_t op = in.u8();
+    if (op > static_cast<std::uint8_t>(Operator::Concat)) in.fail();
+    return static_cast<Operator>(op);
+}
+
+/// @brief Parser output only: bindings and call ids of user functions are left to the resolver
+bool write_expr(Writer& out, const Expr& expr) {
+    using E = Expr;
+
+    write_span(out, expr.span);
+    out.u8(static_cast<std::uint8_t>(expr.value.index()));
+    if (auto lit = std::get_if<E::Literal>(&expr.value)) return write_literal(out, lit->value);
+    if (auto v = std::get_if<E::Variable>(&expr.value)) {
+        out.str(v->name);
+    } else if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        out.u8(static_cast<std::uint8_t>(u->op));
+        out.u32(u->next);
+    } else if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        out.u32(b->left);
+        out.u8(static_cast<std::uint8_t>(b->op));
+        out.u32(b->right);
+    } else if (auto fc = std::get_if<E::FunctionCall>(&expr.value)) {
+        out.str(fc->name);
+        out.ids(fc->args);
+        out.u8(static_cast<std::uint8_t>(fc->target.kind));
+        out.u32(fc->target.id);
+    } else if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        out.u32(t->condition);
+        out.u32(t->then_expr);
+        out.u32(t->else_expr);
+    } else if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        out.ids(ll->elements);
+    } else if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        write_type(out, tc->target_type);
+        out.u32(tc->expr);
+    } else if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        out.u32(ma->object);
+        out.str(ma->member);
+    }
+    return true;
+}
+
+/// @brief Reads expression `self`. Children must have lower ids, as the parser always adds them
+/// first; that also rules out cycles in a corrupt file
+Expr read_expr(Reader& in, ExprId self) {
+    using E = Expr;
+
+    Expr expr;
+    expr.span = read_span(in);
+    switch (in.u8()) {
+        case variant_index_v<E::Literal, E::Variant>:
+            expr.value = E::Literal{read_literal(in)};
+            break;
+        case variant_index_v<E::Variable, E::Variant>:
+            expr.value = E::Variable{in.str(), {}};
+            break;
+        case variant_index_v<E::UnaryOp, E::Variant>: {
+            Operator op = read_operator(in);
+            expr.value = E::UnaryOp{op, in.below(self)};
+            break;
+        }
+        case variant_index_v<E::BinaryOp, E::Variant>: {
+            ExprId left = in.below(self);
+            Operator op = read_operator(in);
+            expr.value = E::BinaryOp{left, op, in.below(self)};
+            break;
+        }
+        case variant_index_v<E::FunctionCall, E::Variant>: {
+            std::string name = in.str();
+            std::vector<ExprId> args = in.ids(self);
+            CallTarget target;
+            std::uint8_t kind = in.u8();
+            if (kind > static_cast<std::uint8_t>(CallTarget::Kind::Exit)) in.fail();
+            target.kind = static_cast<CallTarget::Kind>(kind);
+            target.id = in.u32();
+            // Builtin and method ids index dispatch tables
+            if (target.kind == CallTarget::Kind::Builtin &&
+                target.id >= builtin_functions::builtin_count()) {
+                in.fail();
+            }
+            if (target.kind == CallTarget::Kind::Method &&
+                target.id > static_cast<std::uint32_t>(MethodDispatcher::MethodId::Unknown)) {
+                in.fail();
+            }
+            expr.value = E::FunctionCall{std::move(name), std::move(args), target, false};
+            break;
+        }
+        case variant_index_v<E::Ternary, E::Variant>: {
+            ExprId condition = in.below(self);
+            ExprId then_expr = in.below(self);
+            expr.value = E::Ternary{condition, then_expr, in.below(self)};
+            break;
+        }
+        case variant_index_v<E::ListLiteral, E::Variant>:
+            expr.value = E::ListLiteral{in.ids(self)};
+            break;
+        case variant_index_v<E::TypeCast, E::Variant>: {
+            AstType type = read_type(in);
+            expr.value = E::TypeCast{std::move(type), in.below(self)};
+            break;
+        }
+        case variant_index_v<E::MemberAccess, E::Variant>: {
+            ExprId object = in.below(self);
+            expr.value = E::MemberAccess{object, in.str()};
+            break;
+        }
+        default:
+            in.fail();
+            break;
+    }
+    return expr;
+}
+
+void write_block(Writer& out, const Block& block) {
+    out.ids(block.statements);
+}
+
+Block read_block(Reader& in, StmtId self) {
+    return Block(in.ids(self));
+}
+
+/// @brief Parser output only: bindings, slot counts and function ids are left to the resolver
+void write_statement(Writer& out, const Statement& s) {
+    using S = Statement;
+
+    out.u8(static_cast<std::uint8_t>(s.value.index()));
+    if (auto a = std::get_if<S::Assignment>(&s.value)) {
+        out.str(a->name);
+        out.u32(a->expr);
+    } else if (auto vd = std::get_if<S::VarDecl>(&s.value)) {
+        out.str(vd->name);
+        write_type(out, vd->type);
+        out.u8(vd->initializer ? 1 : 0);
+        if (vd->initializer) out.u32(*vd->initializer);
+    } else if (auto i = std::get_if<S::If>(&s.value)) {
+        out.u32(i->condition);
+        write_block(out, i->body);
+        out.u32(static_cast<std::uint32_t>(i->elif.size()));
+        for (const auto& [cond, body] : i->elif) {
+            out.u32(cond);
+            write_block(out, body);
+        }
+        write_block(out, i->else_body);
+    } else if (auto w = std::get_if<S::While>(&s.value)) {
+        out.u32(w->condition);
+        write_block(out, w->body);
+    } else if (auto r = std::get_if<S::Return>(&s.value)) {
+        out.u32(r->value);
+    } else if (auto fd = std::get_if<S::FunctionDef>(&s.value)) {
+        out.str(fd->name);
+        out.u32(static_cast<std::uint32_t>(fd->params.size()));
+        for (const auto& [name, type] : fd->params) {
+            out.str(name);
+            write_type(out, type);
+        }
+        write_block(out, fd->body);
+        out.u8(fd->return_type ? 1 : 0);
+        if (fd->return_type) write_type(out, *fd->return_type);
+    } else if (auto es = std::get_if<S::ExpressionStmt>(&s.value)) {
+        out.u32(es->expr);
+    }
+}
+
+/// @brief Reads statement `self`; nested statements must have lower ids (see `read_expr`)
+Statement read_statement(Reader& in, StmtId self, std::uint32_t expr_count) {
+    using S = Statement;
+
+    Statement s;
+    switch (in.u8()) {
+        case variant_index_v<S::Assignment, S::Variant>: {
+            std::string name = in.str();
+            s.value = S::Assignment{std::move(name), in.below(expr_count), {}};
+            break;
+        }
+        case variant_index_v<S::VarDecl, S::Variant>: {
+            std::string name = in.str();
+            AstType type = read_type(in);
+            std::optional<ExprId> initializer;
+            if (in.u8() != 0) initializer = in.below(expr_count);
+            s.value = S::VarDecl{std::move(name), std::move(type), initializer, {}, false};
+            break;
+        }
+        case variant_index_v<S::If, S::Variant>: {
+            ExprId condition = in.below(expr_count);
+            Block body = read_block(in, self);
+            std::vector<std::pair<ExprId, Block>> elif;
+            std::uint32_t n = in.u32();
+            for (std::uint32_t k = 0; k < n && !in.failed(); ++k) {
+                ExprId cond = in.below(expr_count);
+                elif.emplace_back(cond, read_block(in, self));
+            }
+            s.value = S::If{condition, std::move(body), std::move(elif), read_block(in, self)};
+            break;
+        }
+        case variant_index_v<S::While, S::Variant>: {
+            ExprId condition = in.below(expr_count);
+            s.value = S::While{condition, read_block(in, self)};
+            break;
+        }
+        case variant_index_v<S::Return, S::Variant>:
+            s.value = S::Return{in.below(expr_count)};
+            break;
+        case variant_index_v<S::FunctionDef, S::Variant>: {
+            std::string name = in.str();
+            std::vector<std::pair<std::string, AstType>> params;
+            std::uint32_t n = in.u32();
+            for (std::uint32_t k = 0; k < n && !in.failed(); ++k) {
+                std::string pname = in.str();
+                params.emplace_back(std::move(pname), read_type(in));
+            }
+            Block body = read_block(in, self);
+            std::optional<AstType> return_type;
+            if (in.u8() != 0) return_type = read_type(in);
+            s.value = S::FunctionDef{std::move(name), std::move(params), std::move(body),
+                                     std::move(return_type), {}, 0, 0, false};
+            break;
+        }
+        case variant_index_v<S::Break, S::Variant>:
+            s.value = S::Break{};
+            break;
+        case variant_index_v<S::Continue, S::Variant>:
+            s.value = S::Continue{};
+            break;
+        case variant_index_v<S::ExpressionStmt, S::Variant>:
+            s.value = S::ExpressionStmt{in.below(expr_count)};
+            break;
+        default:
+            in.fail();
+            break;
+    }
+    return s;
+}
+
+/// @brief Hash of every builtin and method name in id order. Calls store these ids as numbers, so
+/// adding, removing, renaming or reordering one invalidates existing caches
+std::uint64_t dispatch_fingerprint() {
+    static const std::uint64_t fingerprint = [] {
+        std::string names;
+        for (std::size_t id = 0; id < builtin_functions::builtin_count(); ++id) {
+            names += builtin_functions::builtin_name(static_cast<builtin_functions::BuiltinId>(id));
+            names += '\0';
+        }
+        names += '\0';
+        using MethodDispatcher::MethodId;
+        for (std::size_t id = 0; id < static_cast<std::size_t>(MethodId::Unknown); ++id) {
+            names += MethodDispatcher::methodName(static_cast<MethodId>(id));
+            names += '\0';
+        }
+        return hash_bytes(names);
+    }();
+    return fingerprint;
+}
+
+void write_header(Writer& out, std::string_view source) {
+    out.str(MAGIC);
+    out.u32(FORMAT_VERSION);
+    out.str(COPYCLEANER_VERSION);
+    out.u64(dispatch_fingerprint());
+    out.u64(hash_bytes(source));
+    out.u64(source.size());
+}
+
+/// @return `$XDG_CACHE_HOME/copycleaner`, `~/.cache/copycleaner` without it, or
+/// `%LOCALAPPDATA%\copycleaner` on Windows; empty if none of these is set
+std::filesystem::path cache_dir() {
+#ifdef _WIN32
+    const char* local_app_data = std::getenv("LOCALAPPDATA");
+    if (local_app_data && *local_app_data) {
+        return std::filesystem::path(local_app_data) / "copycleaner";
+    }
+#else
+    // The spec says to ignore a relative XDG_CACHE_HOME
+    const char* cache_home = std::getenv("XDG_CACHE_HOME");
+    if (cache_home && *cache_home == '/') return std::filesystem::path(cache_home) / "copycleaner";
+    const char* home = std::getenv("HOME");
+    if (home && *home == '/') return std::filesystem::path(home) / ".cache" / "copycleaner";
+#endif
+    return {};
+}
+
+#ifndef _WIN32
+/// @brief Reads a cache file, unless someone else could have written it: it must be a regular
+/// file owned by us and writable by nobody else, and not a symlink. Hashes in the header aren't
+/// secret, so the file's origin is all that keeps another user from running code as us
+std::optional<std::string> read_own_file(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+    if (fd < 0) return std::nullopt;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_uid != geteuid() ||
+        (st.st_mode & (S_IWGRP | S_IWOTH)) != 0) {
+        close(fd);
+        return std::nullopt;
+    }
+    std::string data(static_cast<std::size_t>(st.st_size), '\0');
+    std::size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = read(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<std::size_t>(n);
+    }
+    close(fd);
+    data.resize(done);
+    return data;
+}
+
+/// @brief Creates the cache directory owner-only if it is missing
+/// @return false if it couldn't be created, or is a symlink or another user's directory
+bool secure_cache_dir(const std::filesystem::path& dir) {
+    std::error_code ignored;
+    std::filesystem::create_directories(dir.parent_path(), ignored);
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+    struct stat st;
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+    return st.st_uid == geteuid();
+}
+
+/// @brief Creates `path`, which must not exist yet, owner-only and writes `data` to it
+bool write_new_file(const std::string& path, std::string_view data) {
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600);
+    if (fd < 0) return false;
+    while (!data.empty()) {
+        ssize_t n = write(fd, data.data(), data.size());
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return close(fd) == 0 && data.empty();
+}
+#else
+std::optional<std::string> read_own_file(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return std::nullopt;
+    return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+bool secure_cache_dir(const std::filesystem::path& dir) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    return std::filesystem::is_directory(dir, ec);
+}
+
+bool write_new_file(const std::string& path, std::string_view data) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) return false;
+    file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return static_cast<bool>(file);
+}
+#endif
+
+}  // namespace
+
+std::string cache_path(const std::string& script_path) {
+    std::filesystem::path dir = cache_dir();
+    std::error_code ec;
+    std::filesystem::path absolute = std::filesystem::absolute(script_path, ec);
+    if (dir.empty() || ec) return {};
+    absolute = absolute.lexically_normal();
+
+    // The script's name keeps the directory readable; the hash of its full path tells scripts of
+    // the same name apart
+    static constexpr char DIGITS[] = "0123456789abcdef";
+    std::uint64_t hash = hash_bytes(absolute.string());
+    std::string name = absolute.stem().string() + "-";
+    for (int shift = 60; shift >= 0; shift -= 4) name += DIGITS[(hash >> shift) & 0xf];
+    return (dir / (name + ".cclc")).string();
+}
+
+std::optional<Ast> load(const std::string& path, std::string_view source) {
+    if (path.empty()) return std::nullopt;
+    auto file = read_own_file(path);
+    if (!file) return std::nullopt;
+    std::string data = std::move(*file);
+
+    // Compare the whole header before parsing any of the body
+    Writer expected;
+    write_header(expected, source);
+    if (!std::string_view(data).starts_with(expected.data())) return std::nullopt;
+
+    // The file ends in a hash of everything before it
+    if (data.size() < expected.data().size() + 8) return std::nullopt;
+    std::string_view body = std::string_view(data).substr(0, data.size() - 8);
+    Reader trailer(std::string_view(data).substr(body.size()));
+    if (trailer.u64() != hash_bytes(body)) return std::nullopt;
+
+    Reader in(body.substr(expected.data().size()));
+    Ast ast;
+    std::uint32_t expr_count = in.u32();
+    std::uint32_t stmt_count = in.u32();
+    for (std::uint32_t id = 0; id < expr_count && !in.failed(); ++id) {
+        ast.add(read_expr(in, id));
+    }
+    for (std::uint32_t id = 0; id < stmt_count && !in.failed(); ++id) {
+        ast.add(read_statement(in, id, expr_count));
+    }
+    ast.root = in.ids(stmt_count);
+    if (in.failed() || !in.at_end()) return std::nullopt;
+    return ast;
+}
+
+bool store(const std::string& path, std::string_view source, const Ast& ast) {
+    if (path.empty() || !secure_cache_dir(std::filesystem::path(path).parent_path())) return false;
+    Writer out;
+    write_header(out, source);
+    out.u32(ast.exprs.size());
+    out.u32(ast.stmts.size());
+    for (std::uint32_t id = 0; id < ast.exprs.size(); ++id) {
+        if (!write_expr(out, ast.expr(id))) return false;
+    }
+    for (std::uint32_t id = 0; id < ast.stmts.size(); ++id) {
+        write_statement(out, ast.stmt(id));
+    }
+    out.ids(ast.root);
+    out.u64(hash_bytes(out.data()));
+
+    // Write a uniquely named sibling and rename it over the cache, which replaces it atomically
+    std::random_device random;
+    std::string tmp_path = path + "." + std::to_string(random()) + ".tmp";
+    if (!write_new_file(tmp_path, out.data())) {
+        std::error_code ignored;
+        std::filesystem::remove(tmp_path, ignored);
+        return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp_path, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp_path, ec);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace script_cache
@@ -0,0 +1,732 @@
+// server.cpp
+// Implements server.h
+
+#include "server.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "driver.h"
+#include "mapped_file.h"
+#include "utils/regex_methods.hpp"
+
+#ifndef _WIN32
+#include <csignal>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#endif
+
+namespace server {
+
+#ifdef _WIN32
+std::string default_socket_path() {
+    return {};
+}
+
+int serve(const std::string&) {
+    std::cerr << "Error: --daemon needs Unix domain sockets and isn't available on Windows"
+              << std::endl;
+    return 1;
+}
+
+std::optional<int> forward(const std::string&, const std::vector<std::string>&) {
+    return std::nullopt;
+}
+#else
+namespace {
+
+/// number of descriptors a client passes: stdin, stdout and stderr
+constexpr int STREAM_COUNT = 3;
+/// a request larger than this is rejected rather than buffered
+constexpr std::uint32_t MAX_REQUEST_SIZE = 1 << 20;
+/// a client sends its whole request right after connecting; one that stalls longer than this
+/// between reads is dropped, so it can't hold up the connections queued behind it
+constexpr int REQUEST_TIMEOUT_SECONDS = 2;
+
+volatile std::sig_atomic_t stop_requested = 0;
+
+void request_stop(int) {
+    stop_requested = 1;
+}
+
+/// write end of the pipe that wakes the daemon's poll() when a run's child exits
+int child_exited_fd = -1;
+
+void notify_child_exited(int) {
+    int saved = errno;
+    char byte = 0;
+    (void)write(child_exited_fd, &byte, 1);
+    errno = saved;
+}
+
+/// @brief Identity of a script file's contents as far as `stat` can tell
+struct FileStamp {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    std::int64_t mtime_ns;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+std::optional<FileStamp> stamp_of(const std::string& path) {
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0) return std::nullopt;
+#ifdef __APPLE__
+    const auto& mtime = st.st_mtimespec;
+#else
+    const auto& mtime = st.st_mtim;
+#endif
+    return FileStamp{st.st_dev, st.st_ino, st.st_size,
+                     static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec};
+}
+
+/// @brief Compiles the regex literals of `ast` into the daemon's regex cache. Runs happen in
+/// forked children, whose own compilations are lost when they exit
+void warm_regexes(const Ast& ast) {
+    for (ExprId id = 0; id < ast.exprs.size(); ++id) {
+        const auto* literal = std::get_if<Expr::Literal>(&ast.expr(id).value);
+        if (!literal) continue;
+        if (const auto* regex = std::get_if<RuntimeValue::Regex>(&literal->value.value)) {
+            // A regex that doesn't compile is reported by the run that uses it
+            (void)RegexMethods::compile(*regex->re);
+        }
+    }
+}
+
+/// @brief Scripts kept in memory between runs, keyed by absolute path. A script is used as long
+/// as its file's `FileStamp` is unchanged.
+///
+/// On Linux the directories of the scripts are also watched with inotify: when a script's file is
+/// rewritten or replaced, only that script is lexed, parsed and resolved again and swapped in
+/// before the next run, so an edit takes effect without a restart and without the next run paying
+/// for the parse. Runs are served between event batches, so a run never sees a half-swapped
+/// script
+class Residents {
+   public:
+    Residents();
+    ~Residents();
+
+    Residents(const Residents&) = delete;
+    Residents& operator=(const Residents&) = delete;
+
+    /// @return The script, or nullptr if it isn't resident or its file changed since it was loaded
+    const driver::Script* find(const std::string& path, const FileStamp& stamp) const {
+        auto it = scripts_.find(path);
+        return it != scripts_.end() && it->second.stamp == stamp ? &it->second.script : nullptr;
+    }
+
+    /// @brief Keeps `script` loaded from `path` and starts watching its file
+    driver::Script& insert(const std::string& path, driver::Script script, const FileStamp& stamp);
+
+    /// @return Descriptor that becomes readable when watched files change, or -1
+    int watch_fd() const noexcept {
+        return inotify_;
+    }
+
+    /// @brief Reloads the scripts whose files changed; call when `watch_fd()` is readable
+    void process_events();
+
+   private:
+    struct Entry {
+        driver::Script script;
+        FileStamp stamp;
+    };
+
+    void reload(const std::string& path);
+
+    std::unordered_map<std::string, Entry> scripts_;
+    int inotify_ = -1;
+    /// watched directory of each inotify watch
+    std::unordered_map<int, std::filesystem::path> dirs_;
+};
+
+#ifdef __linux__
+Residents::Residents() : inotify_(inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+Residents::~Residents() {
+    if (inotify_ >= 0) close(inotify_);
+}
+
+driver::Script& Residents::insert(const std::string& path, driver::Script script,
+                                  const FileStamp& stamp) {
+    // Watching the directory rather than the file also catches editors that save by writing a
+    // new file and renaming it over the old one
+    if (inotify_ >= 0) {
+        auto dir = std::filesystem::path(path).parent_path();
+        int wd = inotify_add_watch(inotify_, dir.c_str(),
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE);
+        if (wd >= 0) dirs_[wd] = dir;
+    }
+    auto& entry = scripts_.insert_or_assign(path, Entry{std::move(script), stamp}).first->second;
+    return entry.script;
+}
+
+void Residents::process_events() {
+    // Collect the whole batch first, so a file written several times is reloaded once
+    std::unordered_set<std::string> changed;
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        ssize_t n = read(inotify_, buffer, sizeof buffer);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        for (char* p = buffer; p < buffer + n;) {
+            auto* event = reinterpret_cast<inotify_event*>(p);
+            p += sizeof(inotify_event) + event->len;
+            auto dir = dirs_.find(event->wd);
+            if (dir == dirs_.end() || event->len == 0) continue;
+            std::string path = (dir->second / event->name).string();
+            if (scripts_.contains(path)) changed.insert(std::move(path));
+        }
+    }
+    for (const auto& path : changed) reload(path);
+}
+#else
+Residents::Residents() = default;
+Residents::~Residents() = default;
+
+driver::Script& Residents::insert(const std::string& path, driver::Script script,
+                                  const FileStamp& stamp) {
+    auto& entry = scripts_.insert_or_assign(path, Entry{std::move(script), stamp}).first->second;
+    return entry.script;
+}
+
+void Residents::process_events() {}
+#endif
+
+void Residents::reload(const std::string& path) {
+    // A script that is gone or no longer parses is dropped; its next run reports why
+    auto stamp = stamp_of(path);
+    // Read, not mapped: the script may be truncated by an editor while it's being lexed
+    MappedFile file(path, false);
+    std::optional<driver::Script> script;
+    if (stamp && file.is_open()) script = driver::load_script(path, file.view(), true);
+    if (!script) {
+        scripts_.erase(path);
+        return;
+    }
+    script->origin = driver::Origin::Resident;
+    warm_regexes(script->ast);
+    scripts_.insert_or_assign(path, Entry{std::move(*script), *stamp});
+    std::cerr << "copycleaner: reloaded " << path << std::endl;
+}
+
+bool send_all(int fd, const char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = send(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool recv_all(int fd, char* data, std::size_t size) {
+    while (size > 0) {
+        ssize_t n = recv(fd, data, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/// @brief Appends `s` to a request body, prefixed with its length
+void append_string(std::string& out, std::string_view s) {
+    auto size = static_cast<std::uint32_t>(s.size());
+    out.append(reinterpret_cast<const char*>(&size), sizeof size);
+    out.append(s);
+}
+
+/// @brief Splits a request body into its strings: the client's working directory, then its
+/// arguments
+std::optional<std::vector<std::string>> decode_strings(std::string_view body) {
+    std::vector<std::string> out;
+    while (!body.empty()) {
+        std::uint32_t size;
+        if (body.size() < sizeof size) return std::nullopt;
+        std::memcpy(&size, body.data(), sizeof size);
+        body.remove_prefix(sizeof size);
+        if (size > body.size()) return std::nullopt;
+        out.emplace_back(body.substr(0, size));
+        body.remove_prefix(size);
+    }
+    return out;
+}
+
+/// @brief Sockets created by processes of another user are refused
+bool same_user(int fd) {
+#ifdef __linux__
+    struct ucred cred;
+    socklen_t len = sizeof cred;
+    return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 && cred.uid == getuid();
+#else
+    uid_t uid;
+    gid_t gid;
+    return getpeereid(fd, &uid, &gid) == 0 && uid == getuid();
+#endif
+}
+
+/// @brief Reads a request: its length and the client's standard streams, then the body
+/// @param streams Filled with the received descriptors, or -1
+/// @return The body, or nothing if the request is malformed
+std::optional<std::string> receive_request(int fd, int (&streams)[STREAM_COUNT]) {
+    std::fill(std::begin(streams), std::end(streams), -1);
+
+    std::uint32_t size = 0;
+    iovec iov{&size, sizeof size};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * STREAM_COUNT)];
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+    ssize_t n;
+    do {
+        n = recvmsg(fd, &msg, MSG_WAITALL);
+    } while (n < 0 && errno == EINTR);
+
+    // Take ownership of whatever descriptors arrived before validating anything else
+    for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+        if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+        std::size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (std::size_t i = 0; i < count; ++i) {
+            int received;
+            std::memcpy(&received, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+            if (i < STREAM_COUNT && streams[i] < 0) {
+                streams[i] = received;
+            } else {
+                close(received);
+            }
+        }
+    }
+    if (n != static_cast<ssize_t>(sizeof size) || (msg.msg_flags & MSG_CTRUNC)) return std::nullopt;
+    for (int stream : streams) {
+        if (stream < 0) return std::nullopt;
+    }
+    if (size > MAX_REQUEST_SIZE) return std::nullopt;
+
+    std::string body(size, '\0');
+    if (!recv_all(fd, body.data(), body.size())) return std::nullopt;
+    return body;
+}
+
+/// @brief Writes out whatever is buffered for stdout and stderr
+void flush() {
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(stdout);
+    std::fflush(stderr);
+}
+
+/// @brief Puts a client's standard streams and working directory in place of the daemon's for
+/// the duration of a request
+class Redirect {
+   public:
+    Redirect(const int (&streams)[STREAM_COUNT]) {
+        flush();
+        for (int i = 0; i < STREAM_COUNT; ++i) {
+            saved_[i] = dup(i);
+            dup2(streams[i], i);
+        }
+        saved_cwd_ = open(".", O_RDONLY | O_DIRECTORY);
+    }
+    ~Redirect() {
+        flush();
+        // A client that went away leaves the streams failed; the next run must start clean
+        std::cout.clear();
+        std::cerr.clear();
+        for (int i = 0; i < STREAM_COUNT; ++i) {
+            dup2(saved_[i], i);
+            close(saved_[i]);
+        }
+        if (saved_cwd_ >= 0) {
+            if (fchdir(saved_cwd_) != 0) std::perror("copycleaner: restoring working directory");
+            close(saved_cwd_);
+        }
+    }
+
+    Redirect(const Redirect&) = delete;
+    Redirect& operator=(const Redirect&) = delete;
+
+   private:
+    int saved_[STREAM_COUNT];
+    int saved_cwd_;
+};
+
+/// @brief A request's script, ready to run
+struct Request {
+    driver::Options options;
+    /// the script to run; points into `Residents` or at `own`
+    const driver::Script* script = nullptr;
+    /// a script that isn't kept resident (`--no-cache`)
+    std::optional<driver::Script> own;
+    /// `script` if this request made it resident; it becomes `Origin::Resident` once it has run
+    driver::Script* inserted = nullptr;
+};
+
+/// @brief Loads the script a request names, with the client's streams and working directory
+/// already in place
+/// @return The request, or the exit code if it fails before the script can run
+std::variant<Request, int> load_request(const std::vector<std::string>& args,
+                                        Residents& residents) {
+    auto parsed = driver::parse_args(args);
+    if (is_err(parsed)) {
+        std::cerr << "Error: " << parsed.error()->what() << std::endl;
+        return 1;
+    }
+    Request request;
+    request.options = std::move(parsed).value();
+    const auto& options = request.options;
+    if (options.filename.empty() || options.daemon || options.bench_lexer) {
+        driver::print_usage("copycleaner");
+        return 1;
+    }
+
+    std::error_code ec;
+    std::string path = std::filesystem::absolute(options.filename, ec).lexically_normal().string();
+    auto stamp = stamp_of(path);
+    if (ec || !stamp) {
+        std::cerr << "Error: Could not open file '" << options.filename << "'" << std::endl;
+        return 1;
+    }
+
+    // --no-cache bypasses the resident scripts like it bypasses the disk cache
+    if (options.use_cache) {
+        if (auto* resident = residents.find(path, *stamp)) {
+            request.script = resident;
+            return request;
+        }
+    }
+
+    // Read, not mapped: the script may be truncated by an editor while it's being lexed
+    MappedFile file(path, false);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file '" << options.filename << "'" << std::endl;
+        return 1;
+    }
+    auto script = driver::load_script(path, file.view(), options.use_cache);
+    if (!script) return 2;
+    if (!options.use_cache) {
+        request.own = std::move(script);
+        request.script = &*request.own;
+        return request;
+    }
+    request.inserted = &residents.insert(path, std::move(*script), *stamp);
+    request.script = request.inserted;
+    warm_regexes(request.script->ast);
+    return request;
+}
+
+/// @brief A run in progress in a child process
+struct Run {
+    pid_t pid;
+    /// connection of the client waiting for the run's exit code
+    int fd;
+    /// whether the run was killed because its client went away
+    bool killed;
+};
+
+/// @brief Serves one connection; failures only affect that client. The script runs in a forked
+/// child, so a run that never finishes doesn't hold up the daemon
+/// @param inherited Descriptors of the daemon that the child closes
+/// @return The run, which owns `fd` until it is reaped; or nothing if the client has been
+/// answered already and `fd` can be closed
+std::optional<Run> handle_client(int fd, Residents& residents, const std::vector<int>& inherited) {
+    if (!same_user(fd)) return std::nullopt;
+    // Connections are accepted one at a time, so reading the request must not block forever
+    timeval timeout{REQUEST_TIMEOUT_SECONDS, 0};
+    if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) != 0) {
+        return std::nullopt;
+    }
+
+    int streams[STREAM_COUNT];
+    auto body = receive_request(fd, streams);
+    auto strings = body ? decode_strings(*body) : std::nullopt;
+    std::int32_t code = 1;
+    std::optional<Run> run;
+    if (strings && !strings->empty()) {
+        Redirect redirect(streams);
+        if (chdir(strings->front().c_str()) != 0) {
+            std::cerr << "Error: Could not enter '" << strings->front() << "'" << std::endl;
+        } else {
+            auto loaded = load_request({strings->begin() + 1, strings->end()}, residents);
+            if (auto* failed = std::get_if<int>(&loaded)) {
+                code = *failed;
+            } else {
+                Request& request = std::get<Request>(loaded);
+                // Nothing buffered may be written twice, by the daemon and by the child
+                flush();
+                pid_t pid = fork();
+                if (pid == 0) {
+                    for (int other : inherited) close(other);
+                    std::signal(SIGINT, SIG_DFL);
+                    std::signal(SIGTERM, SIG_DFL);
+                    std::signal(SIGCHLD, SIG_DFL);
+                    int exit_code = driver::run_script(*request.script, request.options);
+                    flush();
+                    _exit(exit_code);
+                }
+                if (pid > 0) {
+                    run = Run{pid, fd, false};
+                } else {
+                    // Without a child, run in the daemon itself
+                    code = driver::run_script(*request.script, request.options);
+                }
+                if (request.inserted) request.inserted->origin = driver::Origin::Resident;
+            }
+        }
+    }
+    for (int stream : streams) {
+        if (stream >= 0) close(stream);
+    }
+    if (run) return run;
+    send_all(fd, reinterpret_cast<const char*>(&code), sizeof code);
+    return std::nullopt;
+}
+
+/// @return A connected socket, or -1
+int connect_to(const std::string& socket_path) {
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof addr.sun_path) return -1;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof addr) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// @brief Makes sure no other user controls the directory of `socket_path`, where they could
+/// bind the socket first. A missing directory is created owner-only; a symlink or a directory
+/// owned by another user (root aside) is refused
+bool secure_directory(const std::string& socket_path) {
+    auto dir = std::filesystem::path(socket_path).parent_path();
+    if (dir.empty()) dir = ".";
+    if (mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+    struct stat st;
+    if (lstat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) return false;
+    return st.st_uid == getuid() || st.st_uid == 0;
+}
+
+}  // namespace
+
+std::string default_socket_path() {
+    const char* runtime_dir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir && *runtime_dir) return std::string(runtime_dir) + "/copycleaner.sock";
+    // A directory of our own rather than a bare name in /tmp, which anyone could take first
+    return "/tmp/copycleaner-" + std::to_string(getuid()) + "/copycleaner.sock";
+}
+
+int serve(const std::string& socket_path) {
+    sockaddr_un addr{};
+    if (socket_path.size() >= sizeof addr.sun_path) {
+        std::cerr << "Error: Socket path '" << socket_path << "' is too long" << std::endl;
+        return 1;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    if (!secure_directory(socket_path)) {
+        std::cerr << "Error: The directory of '" << socket_path
+                  << "' is missing, a symlink or owned by another user" << std::endl;
+        return 1;
+    }
+
+    // A socket nobody answers on was left behind by a daemon that didn't shut down cleanly
+    if (int other = connect_to(socket_path); other >= 0) {
+        close(other);
+        std::cerr << "Error: A daemon is already listening on '" << socket_path << "'" << std::endl;
+        return 1;
+    }
+    unlink(socket_path.c_str());
+
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        std::perror("copycleaner: socket");
+        return 1;
+    }
+    // Owner-only permissions from the start, so there's no window where others could connect
+    mode_t old_mask = umask(0077);
+    int bound = bind(listener, reinterpret_cast<sockaddr*>(&addr), sizeof addr);
+    umask(old_mask);
+    if (bound != 0 || listen(listener, 16) != 0) {
+        std::cerr << "Error: Could not listen on '" << socket_path << "': " << std::strerror(errno)
+                  << std::endl;
+        close(listener);
+        return 1;
+    }
+
+    // A client that disappears mid-run must not take the daemon down with it
+    std::signal(SIGPIPE, SIG_IGN);
+    // No SA_RESTART, so a signal interrupts poll()
+    struct sigaction stop {};
+    stop.sa_handler = request_stop;
+    sigemptyset(&stop.sa_mask);
+    sigaction(SIGINT, &stop, nullptr);
+    sigaction(SIGTERM, &stop, nullptr);
+
+    // Children report their exit through a pipe, so poll() sees it like any other event
+    int child_exited[2];
+    if (pipe(child_exited) != 0) {
+        std::perror("copycleaner: pipe");
+        close(listener);
+        unlink(socket_path.c_str());
+        return 1;
+    }
+    for (int end : child_exited) fcntl(end, F_SETFL, fcntl(end, F_GETFL) | O_NONBLOCK);
+    child_exited_fd = child_exited[1];
+    struct sigaction exited {};
+    exited.sa_handler = notify_child_exited;
+    // SA_RESTART, so a child exiting doesn't interrupt the daemon writing to a client
+    exited.sa_flags = SA_NOCLDSTOP | SA_RESTART;
+    sigemptyset(&exited.sa_mask);
+    sigaction(SIGCHLD, &exited, nullptr);
+
+    std::cerr << "copycleaner: listening on " << socket_path << std::endl;
+    Residents residents;
+    std::vector<Run> runs;
+    std::vector<pollfd> fds;
+    while (!stop_requested) {
+        // A client sends nothing after its request, so its connection only becomes readable
+        // when the client goes away
+        fds.assign({{listener, POLLIN, 0}, {child_exited[0], POLLIN, 0},
+                    {residents.watch_fd(), POLLIN, 0}});
+        for (const auto& run : runs) fds.push_back({run.killed ? -1 : run.fd, POLLIN, 0});
+        if (poll(fds.data(), fds.size(), -1) < 0) continue;
+
+        // A client that hung up won't read the exit code; stop its run rather than let a script
+        // that never finishes keep running
+        for (std::size_t i = 0; i < runs.size(); ++i) {
+            if (fds[3 + i].revents != 0) {
+                kill(runs[i].pid, SIGKILL);
+                runs[i].killed = true;
+            }
+        }
+        if (fds[1].revents & POLLIN) {
+            char drained[64];
+            while (read(child_exited[0], drained, sizeof drained) > 0) {
+            }
+            int status;
+            pid_t pid;
+            while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                auto run = std::find_if(runs.begin(), runs.end(),
+                                        [pid](const Run& r) { return r.pid == pid; });
+                if (run == runs.end()) continue;
+                std::int32_t code = WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+                if (!run->killed) {
+                    send_all(run->fd, reinterpret_cast<const char*>(&code), sizeof code);
+                }
+                close(run->fd);
+                runs.erase(run);
+            }
+        }
+        // Reload edited scripts before serving, so the run that follows an edit sees it
+        if (fds[2].revents & POLLIN) residents.process_events();
+        if (!(fds[0].revents & POLLIN)) continue;
+        int fd = accept(listener, nullptr, nullptr);
+        if (fd < 0) continue;
+        // The child keeps only its client's connection and streams
+        std::vector<int> inherited = {listener, child_exited[0], child_exited[1]};
+        if (residents.watch_fd() >= 0) inherited.push_back(residents.watch_fd());
+        for (const auto& run : runs) inherited.push_back(run.fd);
+        if (auto run = handle_client(fd, residents, inherited)) {
+            runs.push_back(*run);
+        } else {
+            close(fd);
+        }
+    }
+
+    // Runs still in progress end with the daemon; their clients see the connection drop
+    for (const auto& run : runs) kill(run.pid, SIGTERM);
+    for (const auto& run : runs) {
+        waitpid(run.pid, nullptr, 0);
+        close(run.fd);
+    }
+    std::signal(SIGCHLD, SIG_DFL);
+    close(child_exited[0]);
+    close(child_exited[1]);
+    close(listener);
+    unlink(socket_path.c_str());
+    return 0;
+}
+
+std::optional<int> forward(const std::string& socket_path, const std::vector<std::string>& args) {
+    int fd = connect_to(socket_path);
+    if (fd < 0) return std::nullopt;
+    // Our streams and arguments only go to a daemon of our own user; someone else may have bound
+    // the socket first
+    if (!same_user(fd)) {
+        close(fd);
+        std::cerr << "Warning: Ignoring '" << socket_path << "', which belongs to another user"
+                  << std::endl;
+        return std::nullopt;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::error_code ec;
+    std::string body;
+    append_string(body, std::filesystem::current_path(ec).string());
+    for (const auto& arg : args) append_string(body, arg);
+
+    // The length travels with the descriptors, the body follows
+    auto size = static_cast<std::uint32_t>(body.size());
+    iovec iov{&size, sizeof size};
+    int streams[STREAM_COUNT] = {STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof streams)] = {};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof control;
+    cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof streams);
+    std::memcpy(CMSG_DATA(c), streams, sizeof streams);
+
+    std::int32_t code = 0;
+    bool sent = sendmsg(fd, &msg, 0) == static_cast<ssize_t>(sizeof size) &&
+                send_all(fd, body.data(), body.size());
+    bool answered = sent && recv_all(fd, reinterpret_cast<char*>(&code), sizeof code);
+    close(fd);
+    if (!answered) {
+        std::cerr << "Error: Lost the connection to the daemon on '" << socket_path << "'"
+                  << std::endl;
+        return 1;
+    }
+    return code;
+}
+#endif
+
+}  // namespace server
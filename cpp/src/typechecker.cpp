@@ -0,0 +1,465 @@
+// typechecker.cpp
+// Implements typechecker.h
+
+#include "typechecker.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "runtime_value.h"
+#include "utils/method_dispatcher.hpp"
+#include "utils/variant_utils.hpp"
+
+namespace typechecker {
+
+namespace {
+
+template <typename T>
+AstType make_type() {
+    AstType type;
+    type.value = T{};
+    return type;
+}
+
+AstType list_of(AstType element) {
+    AstType type;
+    type.value = AstType::List{std::make_unique<AstType>(std::move(element))};
+    return type;
+}
+
+bool is_numeric(const AstType& type) {
+    return std::holds_alternative<AstType::Int>(type.value) ||
+           std::holds_alternative<AstType::Float>(type.value);
+}
+
+const AstType::List* as_list(const AstType& type) {
+    return std::get_if<AstType::List>(&type.value);
+}
+
+bool same_type(const AstType& a, const AstType& b) {
+    if (a.value.index() != b.value.index()) return false;
+    const AstType::List* la = as_list(a);
+    if (!la) return true;
+    const AstType::List* lb = as_list(b);
+    if (!la->element || !lb->element) return !la->element && !lb->element;
+    return same_type(*la->element, *lb->element);
+}
+
+/// @return Whether every value matching `from` also passes `matches_type` for `to`. Ints and
+/// floats match either numeric type
+bool subsumes(const AstType& from, const AstType& to) {
+    if (const AstType::List* target = as_list(to)) {
+        const AstType::List* source = as_list(from);
+        if (!source) return false;
+        if (!target->element) return true;
+        return source->element && subsumes(*source->element, *target->element);
+    }
+    if (is_numeric(from) && is_numeric(to)) return true;
+    return from.value.index() == to.value.index();
+}
+
+/// @return Whether no value matching `from` passes `matches_type` for `to`. Lists never
+/// contradict each other, since an empty list matches every list type
+bool contradicts(const AstType& from, const AstType& to) {
+    if (is_numeric(from) && is_numeric(to)) return false;
+    return from.value.index() != to.value.index();
+}
+
+/// @return Whether the function checks its returned values against `return_type` at all; the
+/// engines ignore a declared `null` return type
+bool checks_returns(const Statement::FunctionDef& fd) {
+    return fd.return_type && !std::holds_alternative<AstType::Null>(fd.return_type->value);
+}
+
+}  // namespace
+
+std::vector<Error> TypeChecker::check(Ast& ast) {
+    ast_ = &ast;
+    declared_.clear();
+    stores_.clear();
+    functions_.clear();
+    errors_.clear();
+
+    for (auto id : ast.root) collect_statement(id);
+
+    // Start from every declared type being reliable and drop those with a store that can't be
+    // proven, until the rest only depend on each other
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        infer_all();
+        for (const auto& [name, value] : stores_) {
+            // Names that are only ever assigned have no declared type to rely on anyway
+            auto it = declared_.find(name);
+            if (it == declared_.end() || !it->second.reliable) continue;
+            if (!proves(value, it->second.type)) {
+                it->second.reliable = false;
+                changed = true;
+            }
+        }
+    }
+
+    for (auto id : ast.root) check_statement(id);
+
+    ast_ = nullptr;
+    function_ = nullptr;
+    return std::move(errors_);
+}
+
+void TypeChecker::collect_statement(StmtId id) {
+    const Statement& s = ast_->stmt(id);
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
+        stores_.emplace_back(a->name, a->expr);
+        return;
+    }
+
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
+        declare(vd->name, vd->type, vd->initializer.has_value());
+        if (vd->initializer) stores_.emplace_back(vd->name, *vd->initializer);
+        return;
+    }
+
+    if (auto i = std::get_if<Statement::If>(&s.value)) {
+        collect_block(i->body);
+        for (const auto& [cond, body] : i->elif) collect_block(body);
+        collect_block(i->else_body);
+        return;
+    }
+
+    if (auto w = std::get_if<Statement::While>(&s.value)) {
+        collect_block(w->body);
+        return;
+    }
+
+    if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
+        functions_[fd->function_id].push_back(fd);
+        // Arguments are checked on call, or proven to match
+        for (const auto& [name, type] : fd->params) declare(name, type, true);
+        collect_block(fd->body);
+    }
+}
+
+void TypeChecker::collect_block(const Block& block) {
+    for (auto id : block.statements) collect_statement(id);
+}
+
+void TypeChecker::declare(const std::string& name, const AstType& type, bool has_value) {
+    auto [it, inserted] = declared_.try_emplace(name, Declared{type, has_value});
+    // A declaration without a value leaves null in the variable
+    if (!inserted && !same_type(it->second.type, type)) it->second.reliable = false;
+    if (!has_value) it->second.reliable = false;
+}
+
+void TypeChecker::infer_all() {
+    types_.assign(ast_->exprs.size(), std::nullopt);
+    for (ExprId id = 0; id < ast_->exprs.size(); ++id) types_[id] = infer_expr(id);
+}
+
+std::optional<AstType> TypeChecker::infer_expr(ExprId id) const {
+    using E = Expr;
+    const Expr& expr = ast_->expr(id);
+
+    if (auto lit = std::get_if<E::Literal>(&expr.value)) {
+        switch (lit->value.value.index()) {
+            case variant_index_v<RuntimeValue::Int, RuntimeValue::Variant>:
+                return make_type<AstType::Int>();
+            case variant_index_v<RuntimeValue::Float, RuntimeValue::Variant>:
+                return make_type<AstType::Float>();
+            case variant_index_v<RuntimeValue::Bool, RuntimeValue::Variant>:
+                return make_type<AstType::Bool>();
+            case variant_index_v<RuntimeValue::String, RuntimeValue::Variant>:
+                return make_type<AstType::String>();
+            case variant_index_v<RuntimeValue::Regex, RuntimeValue::Variant>:
+                return make_type<AstType::Regex>();
+            case variant_index_v<RuntimeValue::Null, RuntimeValue::Variant>:
+                return make_type<AstType::Null>();
+            default:
+                return std::nullopt;
+        }
+    }
+
+    if (auto v = std::get_if<E::Variable>(&expr.value)) {
+        auto it = declared_.find(v->name);
+        if (it == declared_.end() || !it->second.reliable) return std::nullopt;
+        return it->second.type;
+    }
+
+    if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        if (u->op == Operator::Not) return make_type<AstType::Bool>();
+        const auto& operand = types_[u->next];
+        if (operand && is_numeric(*operand)) return operand;
+        return std::nullopt;
+    }
+
+    if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        switch (b->op) {
+            case Operator::Add:
+            case Operator::Sub:
+            case Operator::Mul:
+            case Operator::Div:
+            case Operator::Pow: {
+                // Either numeric type will do, both match `int` and `float`
+                const auto& left = types_[b->left];
+                const auto& right = types_[b->right];
+                if (left && right && is_numeric(*left) && is_numeric(*right)) return left;
+                return std::nullopt;
+            }
+            case Operator::Concat:
+                return make_type<AstType::String>();
+            default:
+                // Comparisons and logical operators
+                return make_type<AstType::Bool>();
+        }
+    }
+
+    if (auto fc = std::get_if<E::FunctionCall>(&expr.value)) {
+        if (fc->target.kind == CallTarget::Kind::Method) return infer_method(*fc);
+        if (fc->target.kind == CallTarget::Kind::Function) return infer_call(*fc);
+        return std::nullopt;
+    }
+
+    if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        const auto& then_type = types_[t->then_expr];
+        const auto& else_type = types_[t->else_expr];
+        if (!then_type || !else_type) return std::nullopt;
+        if (same_type(*then_type, *else_type)) return then_type;
+        if (is_numeric(*then_type) && is_numeric(*else_type)) return then_type;
+        return std::nullopt;
+    }
+
+    if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        if (ll->elements.empty()) return std::nullopt;
+        const auto& first = types_[ll->elements.front()];
+        if (!first) return std::nullopt;
+        for (auto element : ll->elements) {
+            if (!types_[element] || !same_type(*types_[element], *first)) return std::nullopt;
+        }
+        return list_of(*first);
+    }
+
+    if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        // Only casts to these types produce a value of the target type
+        const AstType& target = tc->target_type;
+        if (is_numeric(target) || std::holds_alternative<AstType::String>(target.value) ||
+            std::holds_alternative<AstType::Bool>(target.value)) {
+            return target;
+        }
+        return std::nullopt;
+    }
+
+    if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        // Whatever the object, these members either have this type or fail
+        if (ma->member == "start" || ma->member == "end") return make_type<AstType::Int>();
+        if (ma->member == "content" || ma->member == "re" || ma->member == "flags") {
+            return make_type<AstType::String>();
+        }
+        return std::nullopt;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<AstType> TypeChecker::infer_method(const Expr::FunctionCall& fc) const {
+    using M = MethodDispatcher::MethodId;
+    if (fc.args.empty()) return std::nullopt;
+    const auto& receiver = types_[fc.args[0]];
+    const AstType::List* list = receiver ? as_list(*receiver) : nullptr;
+
+    switch (static_cast<M>(fc.target.id)) {
+        case M::Length:
+        case M::IndexOf:
+            return make_type<AstType::Int>();
+        case M::Contains:
+        case M::StartsWith:
+        case M::EndsWith:
+        case M::HasMatch:
+            return make_type<AstType::Bool>();
+        case M::ReplaceAll:
+        case M::ToUpper:
+        case M::ToLower:
+        case M::Trim:
+        case M::Substring:
+        case M::Replace:
+        case M::ReplaceMatch:
+            return make_type<AstType::String>();
+        case M::Split:
+            return list_of(make_type<AstType::String>());
+        case M::GetAll:
+            return list_of(make_type<AstType::Match>());
+        case M::Get:
+            if (list && list->element) return *list->element;
+            return std::nullopt;
+        case M::Slice:
+            if (list) return receiver;
+            return std::nullopt;
+        case M::Push:
+            // The pushed value has to keep the element type
+            if (!list) return std::nullopt;
+            if (!list->element) return receiver;
+            if (fc.args.size() == 2 && proves(fc.args[1], *list->element)) return receiver;
+            return std::nullopt;
+        default:
+            return std::nullopt;
+    }
+}
+
+std::optional<AstType> TypeChecker::infer_call(const Expr::FunctionCall& fc) const {
+    // Returned values are checked against the declared type, or proven to match it. Which
+    // definition runs depends on the order they execute in, so all have to agree
+    auto it = functions_.find(fc.target.id);
+    if (it == functions_.end()) return std::nullopt;
+    const AstType* type = nullptr;
+    for (const Statement::FunctionDef* fd : it->second) {
+        if (!checks_returns(*fd)) return std::nullopt;
+        if (type && !same_type(*type, *fd->return_type)) return std::nullopt;
+        type = &*fd->return_type;
+    }
+    return *type;
+}
+
+bool TypeChecker::proves(ExprId id, const AstType& type) const {
+    const Expr& expr = ast_->expr(id);
+    // An empty list literal matches every list type, so these are looked at element by element
+    if (auto ll = std::get_if<Expr::ListLiteral>(&expr.value)) {
+        const AstType::List* list = as_list(type);
+        if (!list) return false;
+        if (!list->element) return true;
+        return std::all_of(ll->elements.begin(), ll->elements.end(),
+                           [&](ExprId element) { return proves(element, *list->element); });
+    }
+    if (auto t = std::get_if<Expr::Ternary>(&expr.value)) {
+        return proves(t->then_expr, type) && proves(t->else_expr, type);
+    }
+    const auto& inferred = types_[id];
+    return inferred && subsumes(*inferred, type);
+}
+
+void TypeChecker::check_statement(StmtId id) {
+    Statement& s = ast_->stmt(id);
+    if (auto a = std::get_if<Statement::Assignment>(&s.value)) {
+        check_expr(a->expr);
+        return;
+    }
+
+    if (auto vd = std::get_if<Statement::VarDecl>(&s.value)) {
+        vd->initializer_proven = false;
+        if (!vd->initializer) return;
+        check_expr(*vd->initializer);
+        vd->initializer_proven = proves(*vd->initializer, vd->type);
+        if (!vd->initializer_proven) {
+            report_mismatch(*vd->initializer, vd->type,
+                            "initializer type does not match declared type");
+        }
+        return;
+    }
+
+    if (auto i = std::get_if<Statement::If>(&s.value)) {
+        check_expr(i->condition);
+        check_block(i->body);
+        for (auto& [cond, body] : i->elif) {
+            check_expr(cond);
+            check_block(body);
+        }
+        check_block(i->else_body);
+        return;
+    }
+
+    if (auto w = std::get_if<Statement::While>(&s.value)) {
+        check_expr(w->condition);
+        check_block(w->body);
+        return;
+    }
+
+    if (auto r = std::get_if<Statement::Return>(&s.value)) {
+        check_expr(r->value);
+        if (!function_ || !function_->return_type) return;
+        if (!proves(r->value, *function_->return_type)) {
+            function_->returns_proven = false;
+            if (checks_returns(*function_)) {
+                report_mismatch(
+                    r->value, *function_->return_type,
+                    "function returned value that does not match declared return type");
+            }
+        }
+        return;
+    }
+
+    if (auto fd = std::get_if<Statement::FunctionDef>(&s.value)) {
+        Statement::FunctionDef* outer = function_;
+        function_ = fd;
+        fd->returns_proven = fd->return_type.has_value();
+        check_block(fd->body);
+        function_ = outer;
+        return;
+    }
+
+    if (auto es = std::get_if<Statement::ExpressionStmt>(&s.value)) {
+        check_expr(es->expr);
+    }
+}
+
+void TypeChecker::check_block(Block& block) {
+    for (auto id : block.statements) check_statement(id);
+}
+
+void TypeChecker::check_expr(ExprId id) {
+    using E = Expr;
+    Expr& expr = ast_->expr(id);
+
+    if (auto u = std::get_if<E::UnaryOp>(&expr.value)) {
+        check_expr(u->next);
+    } else if (auto b = std::get_if<E::BinaryOp>(&expr.value)) {
+        check_expr(b->left);
+        check_expr(b->right);
+    } else if (auto t = std::get_if<E::Ternary>(&expr.value)) {
+        check_expr(t->condition);
+        check_expr(t->then_expr);
+        check_expr(t->else_expr);
+    } else if (auto ll = std::get_if<E::ListLiteral>(&expr.value)) {
+        for (auto element : ll->elements) check_expr(element);
+    } else if (auto tc = std::get_if<E::TypeCast>(&expr.value)) {
+        check_expr(tc->expr);
+    } else if (auto ma = std::get_if<E::MemberAccess>(&expr.value)) {
+        check_expr(ma->object);
+    }
+
+    auto fc = std::get_if<E::FunctionCall>(&expr.value);
+    if (!fc) return;
+    for (auto arg : fc->args) check_expr(arg);
+    fc->args_proven = false;
+    if (fc->target.kind != CallTarget::Kind::Function) return;
+    auto it = functions_.find(fc->target.id);
+    if (it == functions_.end()) return;
+
+    // Calls with the wrong number of arguments fail on that before the types are looked at
+    const auto& definitions = it->second;
+    auto arity_matches = [&](const Statement::FunctionDef* fd) {
+        return fd->params.size() == fc->args.size();
+    };
+    if (!std::all_of(definitions.begin(), definitions.end(), arity_matches)) return;
+
+    fc->args_proven = true;
+    for (const Statement::FunctionDef* fd : definitions) {
+        for (std::size_t i = 0; i < fc->args.size(); ++i) {
+            if (!proves(fc->args[i], fd->params[i].second)) fc->args_proven = false;
+        }
+    }
+    if (fc->args_proven || definitions.size() != 1) return;
+    for (std::size_t i = 0; i < fc->args.size(); ++i) {
+        const AstType& type = definitions.front()->params[i].second;
+        auto before = errors_.size();
+        report_mismatch(fc->args[i], type, "argument type mismatch");
+        // The first mismatching argument fails the call
+        if (errors_.size() != before) break;
+    }
+}
+
+void TypeChecker::report_mismatch(ExprId id, const AstType& type, const char* message) {
+    const auto& inferred = types_[id];
+    if (inferred && contradicts(*inferred, type)) {
+        errors_.emplace_back(std::string(message), ast_->expr(id).span, ErrorKind::Type);
+    }
+}
+
+}  // namespace typechecker
@@ -1,114 +1,126 @@
 #include "../include/utils/method_dispatcher.hpp"
 
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
 #include "../include/errors.hpp"
 #include "../include/utils/list_methods.hpp"
 #include "../include/utils/regex_methods.hpp"
 #include "../include/utils/string_methods.hpp"
+#include "../include/utils/variant_utils.hpp"
 
 namespace MethodDispatcher {
 
-Result<RuntimeValue> dispatchMethod(const std::string& methodName,
-                                    const std::vector<RuntimeValue>& args) {
-    // Handle methods that work on multiple types
-    if (methodName == "__method_length") {
-        if (args.size() < 1) {
-            return err<RuntimeValue>(
-                std::make_shared<Error>("length() expects 0 arguments", ErrorKind::Arity));
-        }
-
-        if (std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-            return StringMethods::length(args);
-        } else if (std::holds_alternative<RuntimeValue::List>(args[0].value)) {
-            return ListMethods::length(args);
-        } else {
-            return err<RuntimeValue>(std::make_shared<Error>(
-                "length() can only be called on string or list type", ErrorKind::Type));
-        }
-    }
+namespace {
 
-    if (methodName == "__method_contains") {
-        if (args.size() < 1) {
-            return err<RuntimeValue>(
-                std::make_shared<Error>("contains() expects 1 argument", ErrorKind::Arity));
-        }
-
-        if (std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-            return StringMethods::contains(args);
-        } else if (std::holds_alternative<RuntimeValue::List>(args[0].value)) {
-            return ListMethods::contains(args);
-        } else {
-            return err<RuntimeValue>(std::make_shared<Error>(
-                "contains() can only be called on string or list type", ErrorKind::Type));
-        }
-    }
+using Handler = Result<RuntimeValue> (*)(const std::vector<RuntimeValue>&);
 
-    if (methodName == "__method_indexOf") {
-        if (args.size() < 1) {
-            return err<RuntimeValue>(
-                std::make_shared<Error>("indexOf() expects 1 argument", ErrorKind::Arity));
-        }
-
-        if (std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-            return StringMethods::indexOf(args);
-        } else if (std::holds_alternative<RuntimeValue::List>(args[0].value)) {
-            return ListMethods::indexOf(args);
-        } else {
-            return err<RuntimeValue>(std::make_shared<Error>(
-                "indexOf() can only be called on string or list type", ErrorKind::Type));
-        }
-    }
+constexpr std::size_t METHOD_COUNT = static_cast<std::size_t>(MethodId::Unknown);
+constexpr std::size_t TYPE_COUNT = std::variant_size_v<RuntimeValue::Variant>;
+
+template <typename T>
+constexpr std::size_t TYPE = variant_index_v<T, RuntimeValue::Variant>;
+
+struct MethodEntry {
+    const char* name = "";
+    // Receiver types for the error message, e.g. "string or list"
+    const char* receivers = "";
+    // Indexed by the receiver's variant index; nullptr if the type has no such method
+    std::array<Handler, TYPE_COUNT> handlers{};
+};
+
+using MethodTable = std::array<MethodEntry, METHOD_COUNT>;
+
+MethodTable buildTable() {
+    MethodTable table{};
+    auto add = [&](MethodId id, const char* name, const char* receivers,
+                   std::initializer_list<std::pair<std::size_t, Handler>> handlers) {
+        MethodEntry& entry = table[static_cast<std::size_t>(id)];
+        entry.name = name;
+        entry.receivers = receivers;
+        // A method of a single type reports wrong receivers itself, after checking its arity
+        if (handlers.size() == 1) entry.handlers.fill(handlers.begin()->second);
+        for (const auto& [type, handler] : handlers) entry.handlers[type] = handler;
+    };
+
+    using S = RuntimeValue::String;
+    using L = RuntimeValue::List;
+    using R = RuntimeValue::Regex;
+
+    // Methods that work on multiple types
+    add(MethodId::Length, "length", "string or list",
+        {{TYPE<S>, StringMethods::length}, {TYPE<L>, ListMethods::length}});
+    add(MethodId::Contains, "contains", "string or list",
+        {{TYPE<S>, StringMethods::contains}, {TYPE<L>, ListMethods::contains}});
+    add(MethodId::IndexOf, "indexOf", "string or list",
+        {{TYPE<S>, StringMethods::indexOf}, {TYPE<L>, ListMethods::indexOf}});
+    add(MethodId::ReplaceAll, "replaceAll", "string or regex",
+        {{TYPE<S>, StringMethods::replaceAll}, {TYPE<R>, RegexMethods::replaceAll}});
 
     // String methods
-    if (methodName == "__method_toUpper") {
-        return StringMethods::toUpper(args);
-    }
-    if (methodName == "__method_toLower") {
-        return StringMethods::toLower(args);
-    }
-    if (methodName == "__method_trim") {
-        return StringMethods::trim(args);
-    }
-    if (methodName == "__method_substring") {
-        return StringMethods::substring(args);
-    }
-    if (methodName == "__method_replace") {
-        return StringMethods::replace(args);
-    }
-    if (methodName == "__method_startsWith") {
-        return StringMethods::startsWith(args);
-    }
-    if (methodName == "__method_endsWith") {
-        return StringMethods::endsWith(args);
-    }
-    if (methodName == "__method_split") {
-        return StringMethods::split(args);
-    }
-    if (methodName == "__method_hasMatch") {
-        return StringMethods::hasMatch(args);
-    }
-    if (methodName == "__method_replaceMatch") {
-        return StringMethods::replaceMatch(args);
-    }
+    add(MethodId::ToUpper, "toUpper", "string", {{TYPE<S>, StringMethods::toUpper}});
+    add(MethodId::ToLower, "toLower", "string", {{TYPE<S>, StringMethods::toLower}});
+    add(MethodId::Trim, "trim", "string", {{TYPE<S>, StringMethods::trim}});
+    add(MethodId::Substring, "substring", "string", {{TYPE<S>, StringMethods::substring}});
+    add(MethodId::Replace, "replace", "string", {{TYPE<S>, StringMethods::replace}});
+    add(MethodId::StartsWith, "startsWith", "string", {{TYPE<S>, StringMethods::startsWith}});
+    add(MethodId::EndsWith, "endsWith", "string", {{TYPE<S>, StringMethods::endsWith}});
+    add(MethodId::Split, "split", "string", {{TYPE<S>, StringMethods::split}});
+    add(MethodId::HasMatch, "hasMatch", "string", {{TYPE<S>, StringMethods::hasMatch}});
+    add(MethodId::ReplaceMatch, "replaceMatch", "string",
+        {{TYPE<S>, StringMethods::replaceMatch}});
 
     // List methods
-    if (methodName == "__method_get") {
-        return ListMethods::get(args);
-    }
-    if (methodName == "__method_push") {
-        return ListMethods::push(args);
+    add(MethodId::Get, "get", "list", {{TYPE<L>, ListMethods::get}});
+    add(MethodId::Push, "push", "list", {{TYPE<L>, ListMethods::push}});
+    add(MethodId::Slice, "slice", "list", {{TYPE<L>, ListMethods::slice}});
+
+    // Regex methods
+    add(MethodId::GetAll, "getAll", "regex", {{TYPE<R>, RegexMethods::getAll}});
+    return table;
+}
+
+const MethodTable& methodTable() {
+    static const MethodTable table = buildTable();
+    return table;
+}
+
+}  // namespace
+
+MethodId findMethod(const std::string& name) {
+    const MethodTable& table = methodTable();
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        if (name == table[i].name) return static_cast<MethodId>(i);
     }
-    if (methodName == "__method_slice") {
-        return ListMethods::slice(args);
+    return MethodId::Unknown;
+}
+
+const char* methodName(MethodId id) {
+    if (id == MethodId::Unknown) return "";
+    return methodTable()[static_cast<std::size_t>(id)].name;
+}
+
+Result<RuntimeValue> dispatchMethod(MethodId id, const std::string& methodName,
+                                    const std::vector<RuntimeValue>& args) {
+    if (id == MethodId::Unknown) {
+        return err<RuntimeValue>(Error("Unknown method: " + methodName, ErrorKind::Runtime));
     }
 
-    // Regex methods
-    if (methodName == "__method_getAll") {
-        return RegexMethods::getAll(args);
+    const MethodEntry& entry = methodTable()[static_cast<std::size_t>(id)];
+    if (args.empty()) {
+        return err<RuntimeValue>(Error(
+            std::string(entry.name) + "() called without a receiver", ErrorKind::Arity));
     }
 
-    // Method not found
-    return err<RuntimeValue>(
-        std::make_shared<Error>("Unknown method: " + methodName, ErrorKind::Runtime));
+    Handler handler = entry.handlers[args[0].value.index()];
+    if (!handler) {
+        return err<RuntimeValue>(Error(
+            std::string(entry.name) + "() can only be called on " + entry.receivers + " type",
+            ErrorKind::Type));
+    }
+    return handler(args);
 }
 
 }  // namespace MethodDispatcher
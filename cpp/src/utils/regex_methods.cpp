@@ -1,59 +1,204 @@
 #include "../include/utils/regex_methods.hpp"
 
+#include <functional>
+#include <list>
 #include <regex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
 
 #include "../include/errors.hpp"
 
 namespace RegexMethods {
 
+namespace {
+
+using CacheKey = std::pair<std::string, std::string>;  // (literal, flags)
+
+struct CacheKeyHash {
+    std::size_t operator()(const CacheKey& key) const noexcept {
+        std::size_t h = std::hash<std::string>{}(key.first);
+        return h ^ (std::hash<std::string>{}(key.second) + 0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+};
+
+struct CacheEntry {
+    CacheKey key;
+    std::shared_ptr<const regex_engine::Program> program;
+};
+
+// Most recently used entry first; `index` points into `entries`
+struct RegexCache {
+    std::list<CacheEntry> entries;
+    std::unordered_map<CacheKey, std::list<CacheEntry>::iterator, CacheKeyHash> index;
+    CacheStats stats;
+};
+
+RegexCache& cache() {
+    static RegexCache instance;
+    return instance;
+}
+
+// Appends `replacement` to `out`, expanding `$` references against the match in `caps`
+void appendReplacement(std::string& out, const std::string& replacement, std::string_view text,
+                       const regex_engine::Captures& caps) {
+    auto appendGroup = [&](std::size_t g) {
+        if (caps[g].matched()) out.append(text.substr(caps[g].start, caps[g].end - caps[g].start));
+    };
+    auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+
+    for (std::size_t i = 0; i < replacement.size(); ++i) {
+        char c = replacement[i];
+        if (c != '$' || i + 1 == replacement.size()) {
+            out.push_back(c);
+            continue;
+        }
+        char next = replacement[i + 1];
+        if (next == '$') {
+            out.push_back('$');
+            ++i;
+        } else if (next == '&') {
+            appendGroup(0);
+            ++i;
+        } else if (next == '`') {
+            out.append(text.substr(0, caps[0].start));
+            ++i;
+        } else if (next == '\'') {
+            out.append(text.substr(caps[0].end));
+            ++i;
+        } else if (isDigit(next)) {
+            // Two digits win if they name an existing group, like in JavaScript
+            std::size_t group = static_cast<std::size_t>(next - '0');
+            std::size_t digits = 1;
+            if (i + 2 < replacement.size() && isDigit(replacement[i + 2])) {
+                std::size_t two = group * 10 + static_cast<std::size_t>(replacement[i + 2] - '0');
+                if (two >= 1 && two < caps.size()) group = two, digits = 2;
+            }
+            if (group >= 1 && group < caps.size()) {
+                appendGroup(group);
+                i += digits;
+            } else {
+                out.push_back('$');
+            }
+        } else {
+            out.push_back('$');
+        }
+    }
+}
+
+}  // namespace
+
+Result<std::shared_ptr<const regex_engine::Program>> compile(const RegexType& re) {
+    RegexCache& c = cache();
+    CacheKey key{re.literal, re.flags};
+
+    auto it = c.index.find(key);
+    if (it != c.index.end()) {
+        ++c.stats.hits;
+        c.entries.splice(c.entries.begin(), c.entries, it->second);
+        return ok(it->second->program);
+    }
+    ++c.stats.misses;
+
+    auto compiled = regex_engine::compile(re.literal, re.flags);
+    if (is_err(compiled)) return compiled;
+    std::shared_ptr<const regex_engine::Program> program = std::move(compiled).value();
+
+    if (c.entries.size() >= CACHE_CAPACITY) {
+        c.index.erase(c.entries.back().key);
+        c.entries.pop_back();
+    }
+    c.entries.push_front(CacheEntry{key, program});
+    c.index.emplace(std::move(key), c.entries.begin());
+    return ok(std::move(program));
+}
+
+CacheStats cacheStats() {
+    return cache().stats;
+}
+
 Result<RuntimeValue> getAll(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("getAll() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("getAll() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::Regex>(args[0].value)) {
         return err<RuntimeValue>(
-            std::make_shared<Error>("getAll() can only be called on regex type", ErrorKind::Type));
+            Error("getAll() can only be called on regex type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("getAll() expects a string argument", ErrorKind::Type));
+        return err<RuntimeValue>(Error("getAll() expects a string argument", ErrorKind::Type));
     }
 
     auto& regex_val = std::get<RuntimeValue::Regex>(args[0].value);
-    std::string text = std::get<RuntimeValue::String>(args[1].value).value;
+    const Shared<std::string>& source = std::get<RuntimeValue::String>(args[1].value).value;
+    const std::string& text = *source;
 
-    // Convert regex pattern and flags to std::regex
-    std::regex::flag_type flags = std::regex::ECMAScript;
-    for (char c : regex_val.re.flags) {
-        if (c == 'i') flags |= std::regex::icase;
-        // Add more flag support as needed
-    }
+    auto program = compile(*regex_val.re);
+    if (is_err(program)) return err<RuntimeValue>(program.error());
 
     try {
-        std::regex re(regex_val.re.literal, flags);
         std::vector<RuntimeValue> matches;
+        regex_engine::for_each_match(
+            *program.value(), text, [&](const regex_engine::Captures& caps) {
+                const regex_engine::Group& whole = caps[0];
+                RuntimeValue match_val;
+                match_val.value = RuntimeValue::Match{whole.start, whole.end, source};
+                matches.push_back(std::move(match_val));
+            });
 
-        auto words_begin = std::sregex_iterator(text.begin(), text.end(), re);
-        auto words_end = std::sregex_iterator();
+        RuntimeValue result;
+        result.value = RuntimeValue::List{std::move(matches)};
+        return ok(std::move(result));
+    } catch (const std::regex_error& e) {
+        return err<RuntimeValue>(
+            Error(std::string("regex error: ") + e.what(), ErrorKind::Runtime));
+    }
+}
 
-        for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-            std::smatch match = *i;
-            RuntimeValue match_val;
-            match_val.value = RuntimeValue::Match{
-                static_cast<size_t>(match.position()),
-                static_cast<size_t>(match.position() + match.length()), match.str()};
-            matches.push_back(match_val);
-        }
+Result<RuntimeValue> replaceAll(const std::vector<RuntimeValue>& args) {
+    if (args.size() != 3) {
+        return err<RuntimeValue>(Error("replaceAll() expects 2 arguments", ErrorKind::Arity));
+    }
+
+    if (!std::holds_alternative<RuntimeValue::Regex>(args[0].value)) {
+        return err<RuntimeValue>(Error(
+            "replaceAll() can only be called on regex type", ErrorKind::Type));
+    }
+
+    if (!std::holds_alternative<RuntimeValue::String>(args[1].value) ||
+        !std::holds_alternative<RuntimeValue::String>(args[2].value)) {
+        return err<RuntimeValue>(Error(
+            "replaceAll() expects a string and a replacement string", ErrorKind::Type));
+    }
+
+    auto& regex_val = std::get<RuntimeValue::Regex>(args[0].value);
+    const std::string& text = *std::get<RuntimeValue::String>(args[1].value).value;
+    const std::string& replacement = *std::get<RuntimeValue::String>(args[2].value).value;
+
+    auto program = compile(*regex_val.re);
+    if (is_err(program)) return err<RuntimeValue>(program.error());
+
+    try {
+        std::string out;
+        out.reserve(text.size());
+        std::size_t copied = 0;
+        regex_engine::for_each_match(
+            *program.value(), text, [&](const regex_engine::Captures& caps) {
+                out.append(text, copied, caps[0].start - copied);
+                appendReplacement(out, replacement, text, caps);
+                copied = caps[0].end;
+            });
+        out.append(text, copied);
 
         RuntimeValue result;
-        result.value = RuntimeValue::List{std::move(matches)};
-        return ok(result);
+        result.value = RuntimeValue::String{std::move(out)};
+        return ok(std::move(result));
     } catch (const std::regex_error& e) {
         return err<RuntimeValue>(
-            std::make_shared<Error>(std::string("regex error: ") + e.what(), ErrorKind::Runtime));
+            Error(std::string("regex error: ") + e.what(), ErrorKind::Runtime));
     }
 }
 
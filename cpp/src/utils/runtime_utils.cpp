@@ -38,8 +38,7 @@ Result<RuntimeValue> numeric_add(const RuntimeValue& l, const RuntimeValue& r) {
     if (auto la = to_f64(l); la.has_value()) {
         if (auto rb = to_f64(r); rb.has_value()) return ok(make_float(la.value() + rb.value()));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for +", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for +", ErrorKind::Type));
 }
 
 Result<RuntimeValue> numeric_sub(const RuntimeValue& l, const RuntimeValue& r) {
@@ -52,8 +51,7 @@ Result<RuntimeValue> numeric_sub(const RuntimeValue& l, const RuntimeValue& r) {
     if (auto la = to_f64(l); la.has_value()) {
         if (auto rb = to_f64(r); rb.has_value()) return ok(make_float(la.value() - rb.value()));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for -", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for -", ErrorKind::Type));
 }
 
 Result<RuntimeValue> numeric_mul(const RuntimeValue& l, const RuntimeValue& r) {
@@ -66,20 +64,17 @@ Result<RuntimeValue> numeric_mul(const RuntimeValue& l, const RuntimeValue& r) {
     if (auto la = to_f64(l); la.has_value()) {
         if (auto rb = to_f64(r); rb.has_value()) return ok(make_float(la.value() * rb.value()));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for *", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for *", ErrorKind::Type));
 }
 
 Result<RuntimeValue> numeric_div(const RuntimeValue& l, const RuntimeValue& r) {
     // check zero
     if (std::holds_alternative<RuntimeValue::Int>(r.value) &&
         std::get<RuntimeValue::Int>(r.value).value == 0)
-        return err<RuntimeValue>(
-            std::make_shared<Error>("division by zero", ErrorKind::DivideByZero));
+        return err<RuntimeValue>(Error("division by zero", ErrorKind::DivideByZero));
     if (std::holds_alternative<RuntimeValue::Float>(r.value) &&
         std::get<RuntimeValue::Float>(r.value).value == 0.0)
-        return err<RuntimeValue>(
-            std::make_shared<Error>("division by zero", ErrorKind::DivideByZero));
+        return err<RuntimeValue>(Error("division by zero", ErrorKind::DivideByZero));
 
     if (std::holds_alternative<RuntimeValue::Int>(l.value) &&
         std::holds_alternative<RuntimeValue::Int>(r.value)) {
@@ -90,8 +85,7 @@ Result<RuntimeValue> numeric_div(const RuntimeValue& l, const RuntimeValue& r) {
     if (auto la = to_f64(l); la.has_value()) {
         if (auto rb = to_f64(r); rb.has_value()) return ok(make_float(la.value() / rb.value()));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for /", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for /", ErrorKind::Type));
 }
 
 Result<RuntimeValue> numeric_pow(const RuntimeValue& l, const RuntimeValue& r) {
@@ -109,22 +103,34 @@ Result<RuntimeValue> numeric_pow(const RuntimeValue& l, const RuntimeValue& r) {
             return ok(make_float(result));
         }
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for **", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for **", ErrorKind::Type));
 }
 
 Result<RuntimeValue> concat(const RuntimeValue& l, const RuntimeValue& r) {
     if (std::holds_alternative<RuntimeValue::String>(l.value) &&
         std::holds_alternative<RuntimeValue::String>(r.value)) {
-        auto a = std::get<RuntimeValue::String>(l.value).value;
-        auto b = std::get<RuntimeValue::String>(r.value).value;
+        const std::string& a = *std::get<RuntimeValue::String>(l.value).value;
+        const std::string& b = *std::get<RuntimeValue::String>(r.value).value;
         RuntimeValue out;
         out.value = RuntimeValue::String{a + b};
-        return ok(out);
+        return ok(std::move(out));
     }
     RuntimeValue out;
     out.value = RuntimeValue::String{to_string(l) + to_string(r)};
-    return ok(out);
+    return ok(std::move(out));
+}
+
+void concat_in_place(RuntimeValue& l, const RuntimeValue& r) {
+    auto s = std::get_if<RuntimeValue::String>(&l.value);
+    if (!s) {
+        l.value = RuntimeValue::String{to_string(l) + to_string(r)};
+        return;
+    }
+    if (auto rs = std::get_if<RuntimeValue::String>(&r.value)) {
+        s->value.mut() += *rs->value;
+    } else {
+        s->value.mut() += to_string(r);
+    }
 }
 
 Result<RuntimeValue> compare_gt(const RuntimeValue& l, const RuntimeValue& r) {
@@ -132,19 +138,18 @@ Result<RuntimeValue> compare_gt(const RuntimeValue& l, const RuntimeValue& r) {
         if (auto b = to_f64(r); b.has_value()) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{a.value() > b.value()};
-            return ok(out);
+            return ok(std::move(out));
         }
     }
     if (std::holds_alternative<RuntimeValue::String>(l.value) &&
         std::holds_alternative<RuntimeValue::String>(r.value)) {
-        auto a = std::get<RuntimeValue::String>(l.value).value;
-        auto b = std::get<RuntimeValue::String>(r.value).value;
+        const std::string& a = *std::get<RuntimeValue::String>(l.value).value;
+        const std::string& b = *std::get<RuntimeValue::String>(r.value).value;
         RuntimeValue out;
         out.value = RuntimeValue::Bool{a > b};
-        return ok(out);
+        return ok(std::move(out));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for >", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for >", ErrorKind::Type));
 }
 
 Result<RuntimeValue> compare_lt(const RuntimeValue& l, const RuntimeValue& r) {
@@ -152,19 +157,18 @@ Result<RuntimeValue> compare_lt(const RuntimeValue& l, const RuntimeValue& r) {
         if (auto b = to_f64(r); b.has_value()) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{a.value() < b.value()};
-            return ok(out);
+            return ok(std::move(out));
         }
     }
     if (std::holds_alternative<RuntimeValue::String>(l.value) &&
         std::holds_alternative<RuntimeValue::String>(r.value)) {
-        auto a = std::get<RuntimeValue::String>(l.value).value;
-        auto b = std::get<RuntimeValue::String>(r.value).value;
+        const std::string& a = *std::get<RuntimeValue::String>(l.value).value;
+        const std::string& b = *std::get<RuntimeValue::String>(r.value).value;
         RuntimeValue out;
         out.value = RuntimeValue::Bool{a < b};
-        return ok(out);
+        return ok(std::move(out));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for <", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for <", ErrorKind::Type));
 }
 
 Result<RuntimeValue> compare_ge(const RuntimeValue& l, const RuntimeValue& r) {
@@ -172,19 +176,18 @@ Result<RuntimeValue> compare_ge(const RuntimeValue& l, const RuntimeValue& r) {
         if (auto b = to_f64(r); b.has_value()) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{a.value() >= b.value()};
-            return ok(out);
+            return ok(std::move(out));
         }
     }
     if (std::holds_alternative<RuntimeValue::String>(l.value) &&
         std::holds_alternative<RuntimeValue::String>(r.value)) {
-        auto a = std::get<RuntimeValue::String>(l.value).value;
-        auto b = std::get<RuntimeValue::String>(r.value).value;
+        const std::string& a = *std::get<RuntimeValue::String>(l.value).value;
+        const std::string& b = *std::get<RuntimeValue::String>(r.value).value;
         RuntimeValue out;
         out.value = RuntimeValue::Bool{a >= b};
-        return ok(out);
+        return ok(std::move(out));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for >=", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported operand types for >=", ErrorKind::Type));
 }
 
 Result<RuntimeValue> compare_le(const RuntimeValue& l, const RuntimeValue& r) {
@@ -192,19 +195,37 @@ Result<RuntimeValue> compare_le(const RuntimeValue& l, const RuntimeValue& r) {
         if (auto b = to_f64(r); b.has_value()) {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{a.value() <= b.value()};
-            return ok(out);
+            return ok(std::move(out));
         }
     }
     if (std::holds_alternative<RuntimeValue::String>(l.value) &&
         std::holds_alternative<RuntimeValue::String>(r.value)) {
-        auto a = std::get<RuntimeValue::String>(l.value).value;
-        auto b = std::get<RuntimeValue::String>(r.value).value;
+        const std::string& a = *std::get<RuntimeValue::String>(l.value).value;
+        const std::string& b = *std::get<RuntimeValue::String>(r.value).value;
         RuntimeValue out;
         out.value = RuntimeValue::Bool{a <= b};
-        return ok(out);
+        return ok(std::move(out));
+    }
+    return err<RuntimeValue>(Error("unsupported operand types for <=", ErrorKind::Type));
+}
+
+Result<RuntimeValue> eval_unary_op(Operator op, const RuntimeValue& operand) {
+    if (op == Operator::Not) {
+        RuntimeValue out;
+        out.value = RuntimeValue::Bool{!is_truthy(operand)};
+        return ok(std::move(out));
+    }
+    if (op == Operator::Neg) {
+        // numeric negation
+        if (std::holds_alternative<RuntimeValue::Int>(operand.value)) {
+            return ok(make_int(-std::get<RuntimeValue::Int>(operand.value).value));
+        }
+        if (std::holds_alternative<RuntimeValue::Float>(operand.value)) {
+            return ok(make_float(-std::get<RuntimeValue::Float>(operand.value).value));
+        }
+        return err<RuntimeValue>(Error("unsupported operand type for unary -", ErrorKind::Type));
     }
-    return err<RuntimeValue>(
-        std::make_shared<Error>("unsupported operand types for <=", ErrorKind::Type));
+    return err<RuntimeValue>(Error("unsupported unary operator", ErrorKind::Runtime));
 }
 
 Result<RuntimeValue> eval_binary_op(Operator op, const RuntimeValue& left, const RuntimeValue& right) {
@@ -222,12 +243,12 @@ Result<RuntimeValue> eval_binary_op(Operator op, const RuntimeValue& left, const
         case Operator::Eq: {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{left == right};
-            return ok(out);
+            return ok(std::move(out));
         }
         case Operator::Ne: {
             RuntimeValue out;
             out.value = RuntimeValue::Bool{left != right};
-            return ok(out);
+            return ok(std::move(out));
         }
         case Operator::Gt:
             return compare_gt(left, right);
@@ -240,8 +261,7 @@ Result<RuntimeValue> eval_binary_op(Operator op, const RuntimeValue& left, const
         case Operator::Concat:
             return concat(left, right);
         default:
-            return err<RuntimeValue>(
-                std::make_shared<Error>("unsupported binary operator", ErrorKind::Runtime));
+            return err<RuntimeValue>(Error("unsupported binary operator", ErrorKind::Runtime));
     }
 }
 
@@ -256,15 +276,15 @@ Result<RuntimeValue> cast_value(const RuntimeValue& val, const AstType& target_t
                     auto f = std::get<RuntimeValue::Float>(val.value).value;
                     RuntimeValue result;
                     result.value = RuntimeValue::Int{static_cast<int64_t>(f)};
-                    return ok(result);
+                    return ok(std::move(result));
                 }
                 if (std::holds_alternative<RuntimeValue::Bool>(val.value)) {
                     auto b = std::get<RuntimeValue::Bool>(val.value).value;
                     RuntimeValue result;
                     result.value = RuntimeValue::Int{b ? 1 : 0};
-                    return ok(result);
+                    return ok(std::move(result));
                 }
-                return err<RuntimeValue>(std::make_shared<Error>(
+                return err<RuntimeValue>(Error(
                     "cannot cast to int from this type", ErrorKind::Type));
             },
             [&val](const AstType::Float&) -> Result<RuntimeValue> {
@@ -275,23 +295,23 @@ Result<RuntimeValue> cast_value(const RuntimeValue& val, const AstType& target_t
                     auto i = std::get<RuntimeValue::Int>(val.value).value;
                     RuntimeValue result;
                     result.value = RuntimeValue::Float{static_cast<double>(i)};
-                    return ok(result);
+                    return ok(std::move(result));
                 }
-                return err<RuntimeValue>(std::make_shared<Error>(
+                return err<RuntimeValue>(Error(
                     "cannot cast to float from this type", ErrorKind::Type));
             },
             [&val](const AstType::String&) -> Result<RuntimeValue> {
                 RuntimeValue result;
                 result.value = RuntimeValue::String{to_string(val)};
-                return ok(result);
+                return ok(std::move(result));
             },
             [&val](const AstType::Bool&) -> Result<RuntimeValue> {
                 RuntimeValue result;
                 result.value = RuntimeValue::Bool{is_truthy(val)};
-                return ok(result);
+                return ok(std::move(result));
             },
             [](const auto&) -> Result<RuntimeValue> {
-                return err<RuntimeValue>(std::make_shared<Error>(
+                return err<RuntimeValue>(Error(
                     "type casting not supported for this target type", ErrorKind::Type));
             }
         },
@@ -304,15 +324,15 @@ Result<RuntimeValue> access_member(const RuntimeValue& obj, const std::string& m
         auto& regex_val = std::get<RuntimeValue::Regex>(obj.value);
         if (member == "re") {
             RuntimeValue result;
-            result.value = RuntimeValue::String{regex_val.re.literal};
-            return ok(result);
+            result.value = RuntimeValue::String{regex_val.re->literal};
+            return ok(std::move(result));
         }
         if (member == "flags") {
             RuntimeValue result;
-            result.value = RuntimeValue::String{regex_val.re.flags};
-            return ok(result);
+            result.value = RuntimeValue::String{regex_val.re->flags};
+            return ok(std::move(result));
         }
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "regex type has no member '" + member + "'", ErrorKind::Runtime));
     }
 
@@ -321,31 +341,31 @@ Result<RuntimeValue> access_member(const RuntimeValue& obj, const std::string& m
         auto& match_val = std::get<RuntimeValue::Match>(obj.value);
         if (member == "start") {
             RuntimeValue result;
-            result.value = RuntimeValue::Int{static_cast<int64_t>(match_val.start)};
-            return ok(result);
+            result.value = RuntimeValue::Int{static_cast<int64_t>(match_val.start())};
+            return ok(std::move(result));
         }
         if (member == "end") {
             RuntimeValue result;
-            result.value = RuntimeValue::Int{static_cast<int64_t>(match_val.end)};
-            return ok(result);
+            result.value = RuntimeValue::Int{static_cast<int64_t>(match_val.end())};
+            return ok(std::move(result));
         }
         if (member == "content") {
             RuntimeValue result;
-            result.value = RuntimeValue::String{match_val.content};
-            return ok(result);
+            result.value = RuntimeValue::String{std::string(match_val.content())};
+            return ok(std::move(result));
         }
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "match type has no member '" + member + "'", ErrorKind::Runtime));
     }
 
     // List error
     if (std::holds_alternative<RuntimeValue::List>(obj.value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "list member access requires method call syntax (e.g., .get(index))",
             ErrorKind::Runtime));
     }
 
-    return err<RuntimeValue>(std::make_shared<Error>(
+    return err<RuntimeValue>(Error(
         "member access not supported for this type", ErrorKind::Runtime));
 }
 
@@ -1,5 +1,6 @@
 #include "../include/utils/string_methods.hpp"
 #include "../include/errors.hpp"
+#include "../include/utils/regex_methods.hpp"
 #include <algorithm>
 #include <cctype>
 
@@ -7,74 +8,70 @@ namespace StringMethods {
 
 Result<RuntimeValue> length(const std::vector<RuntimeValue>& args) {
     if (args.size() != 1) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("length() expects 0 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("length() expects 0 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "length() can only be called on string type", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     RuntimeValue result;
-    result.value = RuntimeValue::Int{static_cast<int64_t>(str_val.value.length())};
-    return ok(result);
+    result.value = RuntimeValue::Int{static_cast<int64_t>(str_val.value->length())};
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> toUpper(const std::vector<RuntimeValue>& args) {
     if (args.size() != 1) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("toUpper() expects 0 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("toUpper() expects 0 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "toUpper() can only be called on string type", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
-    std::string upper = str_val.value;
+    std::string upper = *str_val.value;
     std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
 
     RuntimeValue result;
     result.value = RuntimeValue::String{upper};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> toLower(const std::vector<RuntimeValue>& args) {
     if (args.size() != 1) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("toLower() expects 0 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("toLower() expects 0 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "toLower() can only be called on string type", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
-    std::string lower = str_val.value;
+    std::string lower = *str_val.value;
     std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
 
     RuntimeValue result;
     result.value = RuntimeValue::String{lower};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> trim(const std::vector<RuntimeValue>& args) {
     if (args.size() != 1) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("trim() expects 0 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("trim() expects 0 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "trim() can only be called on string type", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
-    std::string trimmed = str_val.value;
+    std::string trimmed = *str_val.value;
 
     // Trim leading whitespace
     trimmed.erase(trimmed.begin(),
@@ -89,23 +86,22 @@ Result<RuntimeValue> trim(const std::vector<RuntimeValue>& args) {
 
     RuntimeValue result;
     result.value = RuntimeValue::String{trimmed};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> substring(const std::vector<RuntimeValue>& args) {
     if (args.size() != 3) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("substring() expects 2 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("substring() expects 2 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "substring() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::Int>(args[1].value) ||
         !std::holds_alternative<RuntimeValue::Int>(args[2].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "substring() expects two integer arguments", ErrorKind::Type));
     }
 
@@ -114,189 +110,197 @@ Result<RuntimeValue> substring(const std::vector<RuntimeValue>& args) {
     int64_t end = std::get<RuntimeValue::Int>(args[2].value).value;
 
     // Handle negative indices
-    if (start < 0) start = static_cast<int64_t>(str_val.value.length()) + start;
-    if (end < 0) end = static_cast<int64_t>(str_val.value.length()) + end;
+    if (start < 0) start = static_cast<int64_t>(str_val.value->length()) + start;
+    if (end < 0) end = static_cast<int64_t>(str_val.value->length()) + end;
 
     // Clamp to valid range
-    start = std::max<int64_t>(0, std::min<int64_t>(start, str_val.value.length()));
-    end = std::max<int64_t>(0, std::min<int64_t>(end, str_val.value.length()));
+    start = std::max<int64_t>(0, std::min<int64_t>(start, str_val.value->length()));
+    end = std::max<int64_t>(0, std::min<int64_t>(end, str_val.value->length()));
 
     if (start > end) {
         RuntimeValue result;
-        result.value = RuntimeValue::String{""};
-        return ok(result);
+        result.value = RuntimeValue::String{std::string()};
+        return ok(std::move(result));
     }
 
     std::string substr =
-        str_val.value.substr(static_cast<size_t>(start), static_cast<size_t>(end - start));
+        str_val.value->substr(static_cast<size_t>(start), static_cast<size_t>(end - start));
     RuntimeValue result;
     result.value = RuntimeValue::String{substr};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> replace(const std::vector<RuntimeValue>& args) {
     if (args.size() != 3) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("replace() expects 2 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("replace() expects 2 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "replace() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value) ||
         !std::holds_alternative<RuntimeValue::String>(args[2].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
-            "replace() expects two string arguments", ErrorKind::Type));
+        return err<RuntimeValue>(Error("replace() expects two string arguments", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& old_str = std::get<RuntimeValue::String>(args[1].value);
     auto& new_str = std::get<RuntimeValue::String>(args[2].value);
 
-    std::string result_str = str_val.value;
+    std::string result_str = *str_val.value;
     size_t pos = 0;
-    while ((pos = result_str.find(old_str.value, pos)) != std::string::npos) {
-        result_str.replace(pos, old_str.value.length(), new_str.value);
-        pos += new_str.value.length();
+    while ((pos = result_str.find(*old_str.value, pos)) != std::string::npos) {
+        result_str.replace(pos, old_str.value->length(), *new_str.value);
+        pos += new_str.value->length();
     }
 
     RuntimeValue result;
     result.value = RuntimeValue::String{result_str};
-    return ok(result);
+    return ok(std::move(result));
+}
+
+Result<RuntimeValue> replaceAll(const std::vector<RuntimeValue>& args) {
+    if (args.size() != 3) {
+        return err<RuntimeValue>(Error("replaceAll() expects 2 arguments", ErrorKind::Arity));
+    }
+
+    if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
+        return err<RuntimeValue>(Error(
+            "replaceAll() can only be called on string type", ErrorKind::Type));
+    }
+
+    if (!std::holds_alternative<RuntimeValue::Regex>(args[1].value) ||
+        !std::holds_alternative<RuntimeValue::String>(args[2].value)) {
+        return err<RuntimeValue>(Error(
+            "replaceAll() expects a regex and a replacement string", ErrorKind::Type));
+    }
+
+    return RegexMethods::replaceAll({args[1], args[0], args[2]});
 }
 
 Result<RuntimeValue> contains(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("contains() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("contains() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "contains() on string expects string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "contains() on string expects a string argument", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& search_str = std::get<RuntimeValue::String>(args[1].value);
 
-    bool found = str_val.value.find(search_str.value) != std::string::npos;
+    bool found = str_val.value->find(*search_str.value) != std::string::npos;
     RuntimeValue result;
     result.value = RuntimeValue::Bool{found};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> startsWith(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("startsWith() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("startsWith() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "startsWith() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
-            "startsWith() expects a string argument", ErrorKind::Type));
+        return err<RuntimeValue>(Error("startsWith() expects a string argument", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& prefix = std::get<RuntimeValue::String>(args[1].value);
 
-    bool starts = str_val.value.size() >= prefix.value.size() &&
-                  str_val.value.compare(0, prefix.value.size(), prefix.value) == 0;
+    bool starts = str_val.value->size() >= prefix.value->size() &&
+                  str_val.value->compare(0, prefix.value->size(), *prefix.value) == 0;
     RuntimeValue result;
     result.value = RuntimeValue::Bool{starts};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> endsWith(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("endsWith() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("endsWith() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "endsWith() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
-            "endsWith() expects a string argument", ErrorKind::Type));
+        return err<RuntimeValue>(Error("endsWith() expects a string argument", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& suffix = std::get<RuntimeValue::String>(args[1].value);
 
-    bool ends = str_val.value.size() >= suffix.value.size() &&
-                str_val.value.compare(str_val.value.size() - suffix.value.size(),
-                                      suffix.value.size(), suffix.value) == 0;
+    bool ends = str_val.value->size() >= suffix.value->size() &&
+                str_val.value->compare(str_val.value->size() - suffix.value->size(),
+                                      suffix.value->size(), *suffix.value) == 0;
     RuntimeValue result;
     result.value = RuntimeValue::Bool{ends};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> indexOf(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("indexOf() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("indexOf() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
-            "indexOf() on string expects string type", ErrorKind::Type));
+        return err<RuntimeValue>(Error("indexOf() on string expects string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "indexOf() on string expects a string argument", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& search_str = std::get<RuntimeValue::String>(args[1].value);
 
-    size_t pos = str_val.value.find(search_str.value);
+    size_t pos = str_val.value->find(*search_str.value);
     int64_t index = (pos == std::string::npos) ? -1 : static_cast<int64_t>(pos);
 
     RuntimeValue result;
     result.value = RuntimeValue::Int{index};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> split(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("split() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("split() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "split() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[1].value)) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("split() expects a string delimiter", ErrorKind::Type));
+        return err<RuntimeValue>(Error("split() expects a string delimiter", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& delimiter = std::get<RuntimeValue::String>(args[1].value);
 
     std::vector<RuntimeValue> parts;
-    std::string text = str_val.value;
+    const std::string& text = *str_val.value;
     size_t pos = 0;
     size_t found;
 
-    if (delimiter.value.empty()) {
+    if (delimiter.value->empty()) {
         // Split into individual characters
         for (char c : text) {
             RuntimeValue part;
@@ -304,11 +308,11 @@ Result<RuntimeValue> split(const std::vector<RuntimeValue>& args) {
             parts.push_back(part);
         }
     } else {
-        while ((found = text.find(delimiter.value, pos)) != std::string::npos) {
+        while ((found = text.find(*delimiter.value, pos)) != std::string::npos) {
             RuntimeValue part;
             part.value = RuntimeValue::String{text.substr(pos, found - pos)};
             parts.push_back(part);
-            pos = found + delimiter.value.length();
+            pos = found + delimiter.value->length();
         }
         // Add remaining part
         RuntimeValue part;
@@ -318,52 +322,49 @@ Result<RuntimeValue> split(const std::vector<RuntimeValue>& args) {
 
     RuntimeValue result;
     result.value = RuntimeValue::List{std::move(parts)};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> hasMatch(const std::vector<RuntimeValue>& args) {
     if (args.size() != 2) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("hasMatch() expects 1 argument", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("hasMatch() expects 1 argument", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "hasMatch() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::Match>(args[1].value)) {
-        return err<RuntimeValue>(
-            std::make_shared<Error>("hasMatch() expects a match argument", ErrorKind::Type));
+        return err<RuntimeValue>(Error("hasMatch() expects a match argument", ErrorKind::Type));
     }
 
     auto& str_val = std::get<RuntimeValue::String>(args[0].value);
     auto& match_val = std::get<RuntimeValue::Match>(args[1].value);
 
-    bool found = str_val.value.find(match_val.content) != std::string::npos;
+    bool found = str_val.value->find(match_val.content()) != std::string::npos;
     RuntimeValue result;
     result.value = RuntimeValue::Bool{found};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 Result<RuntimeValue> replaceMatch(const std::vector<RuntimeValue>& args) {
     if (args.size() != 3) {
-        return err<RuntimeValue>(std::make_shared<Error>(
-            "replaceMatch() expects 2 arguments", ErrorKind::Arity));
+        return err<RuntimeValue>(Error("replaceMatch() expects 2 arguments", ErrorKind::Arity));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[0].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "replaceMatch() can only be called on string type", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::Match>(args[1].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "replaceMatch() expects a match as first argument", ErrorKind::Type));
     }
 
     if (!std::holds_alternative<RuntimeValue::String>(args[2].value)) {
-        return err<RuntimeValue>(std::make_shared<Error>(
+        return err<RuntimeValue>(Error(
             "replaceMatch() expects a string as second argument", ErrorKind::Type));
     }
 
@@ -371,15 +372,16 @@ Result<RuntimeValue> replaceMatch(const std::vector<RuntimeValue>& args) {
     auto& match_val = std::get<RuntimeValue::Match>(args[1].value);
     auto& replacement = std::get<RuntimeValue::String>(args[2].value);
 
-    std::string result_str = str_val.value;
-    if (match_val.start < result_str.length() && match_val.end <= result_str.length() &&
-        match_val.start < match_val.end) {
-        result_str.replace(match_val.start, match_val.end - match_val.start, replacement.value);
+    std::string result_str = *str_val.value;
+    std::size_t start = match_val.start();
+    std::size_t end = match_val.end();
+    if (start < result_str.length() && end <= result_str.length() && start < end) {
+        result_str.replace(start, end - start, *replacement.value);
     }
 
     RuntimeValue result;
     result.value = RuntimeValue::String{result_str};
-    return ok(result);
+    return ok(std::move(result));
 }
 
 }  // namespace StringMethods
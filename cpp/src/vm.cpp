@@ -0,0 +1,446 @@
+// vm.cpp
+// Implements vm.h
+
+#include "vm.h"
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "utils/builtin_functions.h"
+#include "utils/list_methods.hpp"
+#include "utils/method_dispatcher.hpp"
+#include "utils/runtime_utils.h"
+#include "utils/types_utils.hpp"
+
+using bytecode::Instruction;
+using bytecode::NO_OPERAND;
+using bytecode::OpCode;
+
+namespace vm {
+
+static Operator binary_operator(OpCode op) {
+    switch (op) {
+        case OpCode::Add:
+        case OpCode::AddInt:
+        case OpCode::AddFloat:
+            return Operator::Add;
+        case OpCode::Sub:
+        case OpCode::SubInt:
+        case OpCode::SubFloat:
+            return Operator::Sub;
+        case OpCode::Mul:
+        case OpCode::MulInt:
+        case OpCode::MulFloat:
+            return Operator::Mul;
+        case OpCode::Div:
+        case OpCode::DivFloat:
+            return Operator::Div;
+        case OpCode::Pow:
+            return Operator::Pow;
+        case OpCode::Eq:
+        case OpCode::EqInt:
+        case OpCode::EqFloat:
+            return Operator::Eq;
+        case OpCode::Ne:
+        case OpCode::NeInt:
+        case OpCode::NeFloat:
+            return Operator::Ne;
+        case OpCode::Gt:
+        case OpCode::GtInt:
+        case OpCode::GtFloat:
+            return Operator::Gt;
+        case OpCode::Lt:
+        case OpCode::LtInt:
+        case OpCode::LtFloat:
+            return Operator::Lt;
+        case OpCode::Ge:
+        case OpCode::GeInt:
+        case OpCode::GeFloat:
+            return Operator::Ge;
+        case OpCode::Le:
+        case OpCode::LeInt:
+        case OpCode::LeFloat:
+            return Operator::Le;
+        default:
+            return Operator::Concat;
+    }
+}
+
+/// @brief Runs an int×int instruction directly on the payloads, with the results
+/// `runtime_utils::eval_binary_op` would give
+/// @return false, leaving `dst` alone, if an operand isn't an int or `op` isn't an int form
+static bool int_binary(OpCode op, RuntimeValue& dst, const RuntimeValue& lhs,
+                       const RuntimeValue& rhs) {
+    auto l = std::get_if<RuntimeValue::Int>(&lhs.value);
+    auto r = std::get_if<RuntimeValue::Int>(&rhs.value);
+    if (!l || !r) return false;
+    std::int64_t a = l->value;
+    std::int64_t b = r->value;
+    // Ordering compares as doubles, like `runtime_utils::compare_lt`; equality is exact
+    auto da = static_cast<double>(a);
+    auto db = static_cast<double>(b);
+    switch (op) {
+        case OpCode::AddInt:
+            dst.value = RuntimeValue::Int{a + b};
+            break;
+        case OpCode::SubInt:
+            dst.value = RuntimeValue::Int{a - b};
+            break;
+        case OpCode::MulInt:
+            dst.value = RuntimeValue::Int{a * b};
+            break;
+        case OpCode::EqInt:
+            dst.value = RuntimeValue::Bool{a == b};
+            break;
+        case OpCode::NeInt:
+            dst.value = RuntimeValue::Bool{a != b};
+            break;
+        case OpCode::GtInt:
+            dst.value = RuntimeValue::Bool{da > db};
+            break;
+        case OpCode::LtInt:
+            dst.value = RuntimeValue::Bool{da < db};
+            break;
+        case OpCode::GeInt:
+            dst.value = RuntimeValue::Bool{da >= db};
+            break;
+        case OpCode::LeInt:
+            dst.value = RuntimeValue::Bool{da <= db};
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+/// @brief Float×float counterpart of `int_binary`
+/// @return false, leaving `dst` alone, if an operand isn't a float, `op` isn't a float form or
+/// a division is by zero
+static bool float_binary(OpCode op, RuntimeValue& dst, const RuntimeValue& lhs,
+                         const RuntimeValue& rhs) {
+    auto l = std::get_if<RuntimeValue::Float>(&lhs.value);
+    auto r = std::get_if<RuntimeValue::Float>(&rhs.value);
+    if (!l || !r) return false;
+    double a = l->value;
+    double b = r->value;
+    switch (op) {
+        case OpCode::AddFloat:
+            dst.value = RuntimeValue::Float{a + b};
+            break;
+        case OpCode::SubFloat:
+            dst.value = RuntimeValue::Float{a - b};
+            break;
+        case OpCode::MulFloat:
+            dst.value = RuntimeValue::Float{a * b};
+            break;
+        case OpCode::DivFloat:
+            if (b == 0.0) return false;
+            dst.value = RuntimeValue::Float{a / b};
+            break;
+        case OpCode::EqFloat:
+            dst.value = RuntimeValue::Bool{a == b};
+            break;
+        case OpCode::NeFloat:
+            dst.value = RuntimeValue::Bool{a != b};
+            break;
+        case OpCode::GtFloat:
+            dst.value = RuntimeValue::Bool{a > b};
+            break;
+        case OpCode::LtFloat:
+            dst.value = RuntimeValue::Bool{a < b};
+            break;
+        case OpCode::GeFloat:
+            dst.value = RuntimeValue::Bool{a >= b};
+            break;
+        case OpCode::LeFloat:
+            dst.value = RuntimeValue::Bool{a <= b};
+            break;
+        default:
+            return false;
+    }
+    return true;
+}
+
+VM::VM(Interpreter& interp) : interp_(interp) {}
+
+Result<RuntimeValue> VM::run(const bytecode::Program& program) {
+    frames_.clear();
+    functions_.clear();
+    registers_.assign(program.functions[0].num_registers, RuntimeValue{RuntimeValue::Null{}});
+    frames_.push_back(Frame{0, 0, 0, interp_.global_env, 0});
+
+    // Cached state of the innermost frame, refreshed whenever frames are pushed or popped
+    const Instruction* code = program.functions[0].code.data();
+    RuntimeValue* regs = registers_.data();
+    std::size_t pc = 0;
+
+    auto reload = [&]() {
+        const Frame& f = frames_.back();
+        code = program.functions[f.function].code.data();
+        regs = registers_.data() + f.base;
+        pc = f.pc;
+    };
+
+    while (true) {
+        const Instruction& ins = code[pc++];
+        switch (ins.op) {
+            case OpCode::LoadConst:
+                regs[ins.a] = program.constants[ins.b];
+                break;
+
+            case OpCode::Move:
+                regs[ins.a] = regs[ins.b];
+                break;
+
+            case OpCode::LoadVar: {
+                const bytecode::Variable& var = program.variables[ins.b];
+                const RuntimeValue* value = frames_.back().env->get(var.binding);
+                if (!value) {
+                    return err<RuntimeValue>(Error(
+                        "Variable '" + var.name + "' is undefined", ErrorKind::Runtime));
+                }
+                regs[ins.a] = *value;
+                break;
+            }
+
+            case OpCode::TakeVar: {
+                const bytecode::Variable& var = program.variables[ins.b];
+                RuntimeValue* value = frames_.back().env->get(var.binding);
+                if (!value) {
+                    return err<RuntimeValue>(Error(
+                        "Variable '" + var.name + "' is undefined", ErrorKind::Runtime));
+                }
+                // The slot is left holding null rather than a moved-from value, so a read the
+                // compiler failed to rule out (see `may_read`) sees null instead of a dangling
+                // payload
+                regs[ins.a] = std::exchange(*value, RuntimeValue{RuntimeValue::Null{}});
+                // Temporaries above `dst` may still hold copies of the value, which would make
+                // the in-place update that follows copy it
+                const bytecode::FunctionProto& proto = program.functions[frames_.back().function];
+                std::fill(regs + ins.a + 1, regs + proto.num_registers,
+                          RuntimeValue{RuntimeValue::Null{}});
+                break;
+            }
+
+            case OpCode::StoreVar:
+                frames_.back().env->set(program.variables[ins.a].binding, std::move(regs[ins.b]));
+                break;
+
+            case OpCode::TypeCheck:
+                if (!matches_type(regs[ins.a], program.types[ins.b])) {
+                    return err<RuntimeValue>(Error(program.errors[ins.c]));
+                }
+                break;
+
+            case OpCode::EnterBlock:
+                frames_.back().env->clear_slots(ins.a, ins.b);
+                break;
+
+            case OpCode::Not:
+            case OpCode::Neg: {
+                auto r = runtime_utils::eval_unary_op(
+                    ins.op == OpCode::Not ? Operator::Not : Operator::Neg, regs[ins.b]);
+                if (is_err(r)) return r;
+                regs[ins.a] = std::move(r).value();
+                break;
+            }
+
+            case OpCode::ToBool:
+                regs[ins.a] = RuntimeValue{RuntimeValue::Bool{is_truthy(regs[ins.b])}};
+                break;
+
+            case OpCode::AddInt:
+            case OpCode::SubInt:
+            case OpCode::MulInt:
+            case OpCode::EqInt:
+            case OpCode::NeInt:
+            case OpCode::GtInt:
+            case OpCode::LtInt:
+            case OpCode::GeInt:
+            case OpCode::LeInt:
+                if (int_binary(ins.op, regs[ins.a], regs[ins.b], regs[ins.c])) break;
+                // The declared types didn't hold, so take the generic path
+                [[fallthrough]];
+            case OpCode::AddFloat:
+            case OpCode::SubFloat:
+            case OpCode::MulFloat:
+            case OpCode::DivFloat:
+            case OpCode::EqFloat:
+            case OpCode::NeFloat:
+            case OpCode::GtFloat:
+            case OpCode::LtFloat:
+            case OpCode::GeFloat:
+            case OpCode::LeFloat:
+                if (float_binary(ins.op, regs[ins.a], regs[ins.b], regs[ins.c])) break;
+                [[fallthrough]];
+            case OpCode::Add:
+            case OpCode::Sub:
+            case OpCode::Mul:
+            case OpCode::Div:
+            case OpCode::Pow:
+            case OpCode::Eq:
+            case OpCode::Ne:
+            case OpCode::Gt:
+            case OpCode::Lt:
+            case OpCode::Ge:
+            case OpCode::Le:
+            case OpCode::Concat: {
+                auto r =
+                    runtime_utils::eval_binary_op(binary_operator(ins.op), regs[ins.b], regs[ins.c]);
+                if (is_err(r)) return r;
+                regs[ins.a] = std::move(r).value();
+                break;
+            }
+
+            case OpCode::Jump:
+                pc = ins.a;
+                break;
+
+            case OpCode::JumpIfFalse:
+                if (!is_truthy(regs[ins.a])) pc = ins.b;
+                break;
+
+            case OpCode::JumpIfTrue:
+                if (is_truthy(regs[ins.a])) pc = ins.b;
+                break;
+
+            case OpCode::Call: {
+                const bytecode::CallSite& site = program.call_sites[ins.b];
+                // The argument registers are temporaries; moving out of them (and nulling them)
+                // leaves no stale copy sharing a list or string that's later appended in place
+                RuntimeValue* first = regs + ins.c;
+                std::vector<RuntimeValue> args(std::make_move_iterator(first),
+                                               std::make_move_iterator(first + site.argc));
+                std::fill(first, first + site.argc, RuntimeValue{RuntimeValue::Null{}});
+
+                if (site.target.kind == CallTarget::Kind::Exit) {
+                    return err<RuntimeValue>(Error("Program exit requested", ErrorKind::Exit));
+                }
+
+                if (site.target.kind == CallTarget::Kind::Builtin) {
+                    auto r = builtin_functions::call_builtin(
+                        static_cast<builtin_functions::BuiltinId>(site.target.id), args,
+                        interp_.logger, interp_.console, interp_.clipboard, interp_.alert,
+                        &interp_);
+                    if (is_err(r)) return r;
+                    regs[ins.a] = std::move(r).value();
+                    break;
+                }
+
+                if (site.target.kind == CallTarget::Kind::Method) {
+                    auto r = MethodDispatcher::dispatchMethod(
+                        static_cast<MethodDispatcher::MethodId>(site.target.id), site.name, args);
+                    if (is_err(r)) return r;
+                    regs[ins.a] = std::move(r).value();
+                    break;
+                }
+
+                std::uint32_t function = site.target.id < functions_.size()
+                                             ? functions_[site.target.id]
+                                             : bytecode::NO_OPERAND;
+                if (function == bytecode::NO_OPERAND) {
+                    return err<RuntimeValue>(Error(
+                        "attempted to call a non-callable value", ErrorKind::Type));
+                }
+                const bytecode::FunctionProto& callee = program.functions[function];
+                if (callee.params.size() != args.size()) {
+                    return err<RuntimeValue>(Error("argument count mismatch", ErrorKind::Arity));
+                }
+                // Functions see the global scope, never the caller's locals
+                auto env = interp_.acquire_frame(callee.num_slots);
+                for (std::size_t i = 0; i < args.size(); ++i) {
+                    const auto& [slot, type_id] = callee.params[i];
+                    if (!site.args_proven && !matches_type(args[i], program.types[type_id])) {
+                        return err<RuntimeValue>(Error("argument type mismatch", ErrorKind::Type));
+                    }
+                    env->slots[slot] = std::move(args[i]);
+                }
+
+                Frame& caller = frames_.back();
+                caller.pc = pc;
+                std::size_t base =
+                    caller.base + program.functions[caller.function].num_registers;
+                if (registers_.size() < base + callee.num_registers) {
+                    registers_.resize(base + callee.num_registers);
+                }
+                frames_.push_back(Frame{function, 0, base, std::move(env), ins.a});
+                reload();
+                break;
+            }
+
+            case OpCode::NewList: {
+                std::vector<RuntimeValue> values(regs + ins.b, regs + ins.b + ins.c);
+                regs[ins.a] = RuntimeValue{RuntimeValue::List{std::move(values)}};
+                break;
+            }
+
+            case OpCode::Cast: {
+                auto r = runtime_utils::cast_value(regs[ins.b], program.types[ins.c]);
+                if (is_err(r)) return r;
+                regs[ins.a] = std::move(r).value();
+                break;
+            }
+
+            case OpCode::GetMember: {
+                auto r = runtime_utils::access_member(regs[ins.b], program.names[ins.c]);
+                if (is_err(r)) return r;
+                regs[ins.a] = std::move(r).value();
+                break;
+            }
+
+            case OpCode::ListPush: {
+                auto r = ListMethods::pushInPlace(regs[ins.a], std::move(regs[ins.b]));
+                if (is_err(r)) return r;
+                break;
+            }
+
+            case OpCode::StringAppend:
+                runtime_utils::concat_in_place(regs[ins.a], regs[ins.b]);
+                break;
+
+            case OpCode::DefineFunction:
+                if (ins.b >= functions_.size()) functions_.resize(ins.b + 1, bytecode::NO_OPERAND);
+                functions_[ins.b] = ins.a;
+                break;
+
+            case OpCode::Return:
+            case OpCode::ReturnNull: {
+                RuntimeValue value = ins.op == OpCode::Return
+                                         ? std::move(regs[ins.a])
+                                         : RuntimeValue{RuntimeValue::Null{}};
+                if (frames_.size() == 1) return ok(std::move(value));
+
+                const bytecode::FunctionProto& proto = program.functions[frames_.back().function];
+                if (proto.return_type != NO_OPERAND) {
+                    if (ins.op == OpCode::ReturnNull) {
+                        return err<RuntimeValue>(Error(
+                            "function did not return a value but has declared return type",
+                            ErrorKind::Type));
+                    }
+                    if (!proto.returns_proven &&
+                        !matches_type(value, program.types[proto.return_type])) {
+                        return err<RuntimeValue>(Error(
+                            "function returned value that does not match declared return type",
+                            ErrorKind::Type));
+                    }
+                }
+
+                // Clear the callee's registers so none of its temporaries outlive the call
+                std::fill(regs, regs + proto.num_registers, RuntimeValue{RuntimeValue::Null{}});
+                std::uint32_t target = frames_.back().result_register;
+                interp_.release_frame(std::move(frames_.back().env));
+                frames_.pop_back();
+                reload();
+                regs[target] = std::move(value);
+                break;
+            }
+
+            case OpCode::Raise:
+                return err<RuntimeValue>(Error(program.errors[ins.a]));
+        }
+    }
+}
+
+}  // namespace vm
@@ -9,12 +9,21 @@ if (-not (Test-Path $exe)) {
 }
 
 Write-Host "Running comprehensive test..."
-& $exe comprehensive.ccl
+$vmOutput = & $exe --engine=vm comprehensive.ccl 2>&1 | Out-String
+$vmStatus = $LASTEXITCODE
+Write-Host $vmOutput
 
-if ($LASTEXITCODE -eq 0) {
-    Write-Host "[PASS] All tests passed"
-    exit 0
-} else {
+# The tree-walking engine is the reference: both engines must behave identically
+$treeOutput = & $exe --engine=tree comprehensive.ccl 2>&1 | Out-String
+$treeStatus = $LASTEXITCODE
+
+if ($vmStatus -ne 0) {
     Write-Host "[FAIL] Tests failed"
     exit 1
+} elseif (($treeStatus -ne $vmStatus) -or ($treeOutput -ne $vmOutput)) {
+    Write-Host "[FAIL] Bytecode VM and tree walker disagree"
+    exit 1
+} else {
+    Write-Host "[PASS] All tests passed"
+    exit 0
 }
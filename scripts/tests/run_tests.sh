@@ -9,12 +9,46 @@ if [ ! -f "$exe" ]; then
 fi
 
 echo "Running comprehensive test..."
-$exe comprehensive.ccl
+vm_output=$($exe --engine=vm comprehensive.ccl 2>&1)
+vm_status=$?
+echo "$vm_output"
 
-if [ $? -eq 0 ]; then
-    echo "[PASS] All tests passed"
-    exit 0
-else
+# The tree-walking engine is the reference: both engines must behave identically
+tree_output=$($exe --engine=tree comprehensive.ccl 2>&1)
+tree_status=$?
+
+if [ $vm_status -ne 0 ]; then
     echo "[FAIL] Tests failed"
     exit 1
-fi
\ No newline at end of file
+elif [ $tree_status -ne $vm_status ] || [ "$tree_output" != "$vm_output" ]; then
+    echo "[FAIL] Bytecode VM and tree walker disagree"
+    exit 1
+fi
+
+# A script cache that someone else could have written is never loaded
+echo "Running script cache test..."
+cache_home=$(mktemp -d)
+trap 'rm -rf "$cache_home"' EXIT
+cache_status() {
+    XDG_CACHE_HOME="$cache_home" $exe --stats comprehensive.ccl 2>&1 >/dev/null |
+        sed -n 's/^script cache: //p'
+}
+cache_status >/dev/null
+cache_file=$(ls "$cache_home"/copycleaner/*.cclc)
+hit=$(cache_status)
+chmod g+w "$cache_file"
+writable=$(cache_status)
+# Changing a file's owner needs root
+foreign=miss
+if [ "$(id -u)" -eq 0 ]; then
+    chown 65534 "$cache_file"
+    foreign=$(cache_status)
+fi
+
+if [ "$hit" != "hit" ] || [ "$writable" != "miss" ] || [ "$foreign" != "miss" ]; then
+    echo "[FAIL] Script cache used a file it shouldn't trust (hit: $hit, group-writable: $writable, other owner: $foreign)"
+    exit 1
+else
+    echo "[PASS] All tests passed"
+    exit 0
+fi